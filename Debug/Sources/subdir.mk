@@ -4,43 +4,85 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../Sources/Acquisition.c \
+../Sources/AcquisitionDMA.c \
+../Sources/Benchmark.c \
+../Sources/CRC.c \
+../Sources/Capture.c \
+../Sources/DWT.c \
+../Sources/Executive.c \
 ../Sources/FIFO.c \
 ../Sources/Flash.c \
 ../Sources/Frequnency.c \
+../Sources/Idle.c \
 ../Sources/LEDs.c \
+../Sources/Monitor.c \
 ../Sources/PIT.c \
 ../Sources/RMS.c \
+../Sources/Regulator.c \
+../Sources/Sleep.c \
 ../Sources/Spectrum.c \
+../Sources/Stream.c \
+../Sources/Telemetry.c \
 ../Sources/UART.c \
 ../Sources/VRR.c \
+../Sources/Varint.c \
 ../Sources/handle.c \
 ../Sources/main.c \
 ../Sources/packet.c 
 
 OBJS += \
+./Sources/Acquisition.o \
+./Sources/AcquisitionDMA.o \
+./Sources/Benchmark.o \
+./Sources/CRC.o \
+./Sources/Capture.o \
+./Sources/DWT.o \
+./Sources/Executive.o \
 ./Sources/FIFO.o \
 ./Sources/Flash.o \
 ./Sources/Frequnency.o \
+./Sources/Idle.o \
 ./Sources/LEDs.o \
+./Sources/Monitor.o \
 ./Sources/PIT.o \
 ./Sources/RMS.o \
+./Sources/Regulator.o \
+./Sources/Sleep.o \
 ./Sources/Spectrum.o \
+./Sources/Stream.o \
+./Sources/Telemetry.o \
 ./Sources/UART.o \
 ./Sources/VRR.o \
+./Sources/Varint.o \
 ./Sources/handle.o \
 ./Sources/main.o \
 ./Sources/packet.o 
 
 C_DEPS += \
+./Sources/Acquisition.d \
+./Sources/AcquisitionDMA.d \
+./Sources/Benchmark.d \
+./Sources/CRC.d \
+./Sources/Capture.d \
+./Sources/DWT.d \
+./Sources/Executive.d \
 ./Sources/FIFO.d \
 ./Sources/Flash.d \
 ./Sources/Frequnency.d \
+./Sources/Idle.d \
 ./Sources/LEDs.d \
+./Sources/Monitor.d \
 ./Sources/PIT.d \
 ./Sources/RMS.d \
+./Sources/Regulator.d \
+./Sources/Sleep.d \
 ./Sources/Spectrum.d \
+./Sources/Stream.d \
+./Sources/Telemetry.d \
 ./Sources/UART.d \
 ./Sources/VRR.d \
+./Sources/Varint.d \
 ./Sources/handle.d \
 ./Sources/main.d \
 ./Sources/packet.d 
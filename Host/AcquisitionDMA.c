@@ -0,0 +1,134 @@
+/*! @file
+ *
+ *  @brief Routines for the eDMA channels behind the acquisition.
+ *
+ *  Host build - the PIT channel's interrupt stands in for the DMA. It keeps the result and timestamp
+ *  channels' destination and iteration counts the way the TCDs do, reading every input from the analog
+ *  stand-in and stamping each sample with the monotonic clock counted down in module clock cycles, and
+ *  hands over a block at the half way and major loop interrupts like the target.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup AcquisitionDMA_module AcquisitionDMA module documentation
+**  @{
+*/
+/* MODULE AcquisitionDMA */
+
+#include <time.h>
+
+#include "AcquisitionDMA.h"
+#include "analog.h"
+#include "OS.h"
+#include "PIT.h"
+
+// Samples in both blocks - the major loop, with its half way interrupt between the blocks
+#define NB_BUFFER_SAMPLES (2 * ACQUISITION_BLOCK_SAMPLES)
+
+/*!
+ * @struct TTCD
+ * @brief The parts of a transfer control descriptor the stand-in needs.
+ */
+typedef struct
+{
+  uint16_t daddr;                     /*!< Next slot written, from the start of the buffer */
+  uint16_t citer;                     /*!< Minor loops left in the major loop */
+  uint16_t biter;                     /*!< Minor loops per major loop */
+} TTCD;
+
+static uint32_t ModuleClk;
+
+static TAcquisitionSample* Samples;
+static uint32_t* Counts;
+// The result and timestamp channels move together, so one descriptor does for both
+static TTCD TCD;
+
+// The last input's result, read out by the first frame of the next sample
+static int16_t Leftover;
+
+static volatile bool Held;
+
+/*! @brief Gets the monotonic clock counted down in module clock cycles, as the timestamp channel does.
+ *
+ */
+static uint32_t Count(void)
+{
+  struct timespec now;
+  uint64_t cycles;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  cycles = (((uint64_t)now.tv_sec * 1000000000u + now.tv_nsec) * ModuleClk) / 1000000000u;
+  return ~(uint32_t)cycles;
+}
+
+/*! @brief Takes a sample, as the DMA channels do on the target.
+ *
+ *  @note The PIT channel's callback, so it runs as an interrupt.
+ */
+static void Trigger(void* arg)
+{
+  TAcquisitionSample* const sample = &Samples[TCD.daddr];
+
+  if (Held)
+    return;
+
+  Counts[TCD.daddr] = Count();
+
+  sample->unused = Leftover;
+  for (uint8_t channelNb = 0; channelNb < ACQUISITION_NB_CHANNELS; channelNb++)
+    (void)Analog_Get(channelNb, &sample->values[channelNb]);
+  Leftover = sample->values[ACQUISITION_NB_CHANNELS - 1];
+
+  TCD.daddr++;
+  if (--TCD.citer == (TCD.biter / 2))
+  {
+    Acquisition_BlockDone(0);
+  }
+  else if (TCD.citer == 0)
+  {
+    // The last destination adjustment takes the channels back to the first block
+    TCD.daddr = 0;
+    TCD.citer = TCD.biter;
+    Acquisition_BlockDone(1);
+  }
+}
+
+bool AcquisitionDMA_Init(const uint32_t moduleClk, TAcquisitionSample samples[2][ACQUISITION_BLOCK_SAMPLES],
+                         uint32_t counts[2][ACQUISITION_BLOCK_SAMPLES])
+{
+  ModuleClk = moduleClk;
+  Samples = samples[0];
+  Counts = counts[0];
+
+  TCD.daddr = 0;
+  TCD.citer = NB_BUFFER_SAMPLES;
+  TCD.biter = NB_BUFFER_SAMPLES;
+
+  return PIT_ChannelInit(ACQUISITION_PIT_CHANNEL, Trigger, NULL);
+}
+
+void AcquisitionDMA_Start(const uint32_t period)
+{
+  PIT_Set(ACQUISITION_PIT_CHANNEL, period, true);
+}
+
+uint32_t AcquisitionDMA_Count(void)
+{
+  // Not running before AcquisitionDMA_Init
+  return ModuleClk ? Count() : 0xFFFFFFFFu;
+}
+
+void AcquisitionDMA_Hold(const bool hold)
+{
+  // The trigger runs as an interrupt, so it is never part way through a sample here
+  Held = hold;
+}
+
+void __attribute__ ((interrupt)) AcquisitionDMA_ISR(void)
+{
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,158 @@
+/*! @file
+ *
+ *  @brief Reading and writing capture files on the host.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup CaptureFile_module CaptureFile module documentation
+**  @{
+*/
+/* MODULE CaptureFile */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CaptureFile.h"
+#include "Varint.h"
+
+/*! @brief Writes the pending samples as a chunk.
+ *
+ *  @return bool - TRUE if the chunk was written.
+ */
+static bool Flush(TCaptureFile* const capture)
+{
+  static uint8_t chunk[CAPTURE_CHUNK_HEADER_SIZE + CAPTURE_MAX_CHANNELS * CAPTURE_FILE_CHUNK_SAMPLES * VARINT_MAX_BYTES_16];
+  uint32_t size;
+
+  if (capture->count == 0)
+    return true;
+
+  size = Capture_WriteChunk(chunk, capture->pending[0], capture->info.nbChannels, capture->count, CAPTURE_MAX_CHANNELS,
+                            capture->encoding);
+  capture->info.nbSamples += capture->count;
+  capture->count = 0;
+
+  return (size > 0) && (fwrite(chunk, 1, size, capture->file) == size);
+}
+
+/*! @brief Writes the header at the start of the file.
+ *
+ *  @return bool - TRUE if the header was written.
+ */
+static bool WriteHeader(TCaptureFile* const capture)
+{
+  uint8_t header[CAPTURE_HEADER_SIZE];
+
+  return Capture_WriteHeader(header, &capture->info)
+      && (fseek(capture->file, 0, SEEK_SET) == 0)
+      && (fwrite(header, 1, sizeof(header), capture->file) == sizeof(header));
+}
+
+bool CaptureFile_Create(TCaptureFile* const capture, const char* const path, const TCaptureInfo* const info,
+                        const TCaptureEncoding encoding)
+{
+  capture->info = *info;
+  capture->info.nbSamples = 0;
+  capture->encoding = encoding;
+  capture->count = 0;
+
+  capture->file = fopen(path, "wb");
+  if (!capture->file)
+  {
+    perror(path);
+    return false;
+  }
+
+  if (!WriteHeader(capture))
+  {
+    fclose(capture->file);
+    capture->file = NULL;
+    return false;
+  }
+
+  return true;
+}
+
+bool CaptureFile_Append(TCaptureFile* const capture, const int16_t samples[])
+{
+  if (!capture->file)
+    return false;
+
+  for (uint8_t channelNb = 0; channelNb < capture->info.nbChannels; channelNb++)
+    capture->pending[capture->count][channelNb] = samples[channelNb];
+
+  if (++capture->count == CAPTURE_FILE_CHUNK_SAMPLES)
+    return Flush(capture);
+
+  return true;
+}
+
+bool CaptureFile_Close(TCaptureFile* const capture)
+{
+  bool success;
+
+  if (!capture->file)
+    return false;
+
+  // The header is rewritten with the final sample count
+  success = Flush(capture) && WriteHeader(capture);
+  success &= (fclose(capture->file) == 0);
+  capture->file = NULL;
+
+  return success;
+}
+
+bool CaptureFile_Map(const char* const path, TCaptureReader* const reader)
+{
+  struct stat status;
+  void* data;
+  int file = open(path, O_RDONLY);
+
+  if (file < 0)
+  {
+    perror(path);
+    return false;
+  }
+
+  if ((fstat(file, &status) != 0) || (status.st_size == 0) || (status.st_size > UINT32_MAX))
+  {
+    close(file);
+    return false;
+  }
+
+  data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (data == MAP_FAILED)
+  {
+    perror(path);
+    return false;
+  }
+
+  // Read front to back
+  (void)madvise(data, status.st_size, MADV_SEQUENTIAL);
+
+  if (!Capture_ReaderInit(reader, data, (uint32_t)status.st_size))
+  {
+    fprintf(stderr, "%s: not a capture file\n", path);
+    munmap(data, status.st_size);
+    return false;
+  }
+
+  return true;
+}
+
+void CaptureFile_Unmap(TCaptureReader* const reader)
+{
+  if (reader->data)
+    munmap((void*)reader->data, reader->length);
+  reader->data = NULL;
+}
+
+/*!
+** @}
+*/
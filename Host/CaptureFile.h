@@ -0,0 +1,74 @@
+/*! @file
+ *
+ *  @brief Reading and writing capture files on the host.
+ *
+ *  Captures are written a chunk at a time as the samples come in, and read back by mapping the whole
+ *  file into memory so the replay runs straight out of the page cache.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include <stdio.h>
+
+#include "Capture.h"
+
+// Samples per channel in each chunk written
+#define CAPTURE_FILE_CHUNK_SAMPLES 256
+
+/*! @brief A capture being written.
+ *
+ */
+typedef struct
+{
+  FILE* file;                                                           /*!< Where it goes */
+  TCaptureInfo info;                                                    /*!< The header so far */
+  TCaptureEncoding encoding;                                            /*!< How the chunks are stored */
+  uint16_t count;                                                       /*!< Samples waiting in pending */
+  int16_t pending[CAPTURE_FILE_CHUNK_SAMPLES][CAPTURE_MAX_CHANNELS];    /*!< The next chunk, a sample of every channel together */
+} TCaptureFile;
+
+/*! @brief Starts a capture file.
+ *
+ *  @param capture The capture.
+ *  @param path The file name.
+ *  @param info What the capture holds - nbSamples is filled in when it is closed.
+ *  @param encoding How the chunks are stored.
+ *  @return bool - TRUE if the file was created.
+ */
+bool CaptureFile_Create(TCaptureFile* const capture, const char* const path, const TCaptureInfo* const info,
+                        const TCaptureEncoding encoding);
+
+/*! @brief Adds a sample of every channel.
+ *
+ *  @param capture The capture.
+ *  @param samples One sample per channel.
+ *  @return bool - TRUE if the sample was added.
+ */
+bool CaptureFile_Append(TCaptureFile* const capture, const int16_t samples[]);
+
+/*! @brief Writes what is left and the final header, and closes the file.
+ *
+ *  @param capture The capture.
+ *  @return bool - TRUE if all of it was written.
+ */
+bool CaptureFile_Close(TCaptureFile* const capture);
+
+/*! @brief Maps a capture file into memory.
+ *
+ *  @param path The file name.
+ *  @param reader Set up to read the capture.
+ *  @return bool - TRUE if the file was mapped and its header is valid.
+ */
+bool CaptureFile_Map(const char* const path, TCaptureReader* const reader);
+
+/*! @brief Releases a mapped capture file.
+ *
+ *  @param reader The reader set up by CaptureFile_Map.
+ */
+void CaptureFile_Unmap(TCaptureReader* const reader);
+
+#endif
@@ -0,0 +1,22 @@
+/*! @file
+ *
+ *  @brief Clock settings and low level initialisation for the host build.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Cpu_module Cpu module documentation
+**  @{
+*/
+/* MODULE Cpu */
+
+#include "Cpu.h"
+
+void PE_low_level_init(void)
+{
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,28 @@
+/*! @file
+ *
+ *  @brief Clock settings and low level initialisation for the host build.
+ *
+ *  Stands in for the Processor Expert Cpu.h. The clock rates are the K70's, so baud rate and timer
+ *  calculations come out the same as on the target.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef __Cpu_H
+#define __Cpu_H
+
+#include "PE_Types.h"
+#include "PE_Error.h"
+#include "PE_Const.h"
+#include "IO_Map.h"
+
+#define CPU_BUS_CLK_HZ  25000000U /* Initial value of the bus clock frequency in Hz */
+#define CPU_CORE_CLK_HZ 50000000U /* Initial value of the core/system clock frequency in Hz.  */
+
+/*! @brief Sets up the clocks and pins - nothing to do on the host.
+ *
+ */
+void PE_low_level_init(void);
+
+#endif
@@ -0,0 +1,48 @@
+/*! @file
+ *
+ *  @brief Routines for the Cortex-M4 Data Watchpoint and Trace (DWT) cycle counter.
+ *
+ *  Host build - the count is the monotonic clock scaled to the tower's core clock, so it is wall time
+ *  in 50 MHz cycles rather than a count of the host's own cycles.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup DWT_module DWT module documentation
+**  @{
+*/
+/* MODULE DWT */
+
+#include <time.h>
+
+#include "DWT.h"
+#include "Cpu.h"
+
+static uint64_t Start;
+
+/*! @brief Gets the monotonic clock in ns.
+ *
+ */
+static uint64_t Now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+bool DWT_Init(void)
+{
+  Start = Now();
+  return true;
+}
+
+uint32_t DWT_CycleCount(void)
+{
+  return (uint32_t)((Now() - Start) * (CPU_CORE_CLK_HZ / 1000000) / 1000);
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,105 @@
+/*! @file
+ *
+ *  @brief Routines for erasing and writing to the Flash.
+ *
+ *  Host build - the 8-byte data sector is held in RAM, so nothing survives a restart.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Flash_module Flash module documentation
+**  @{
+*/
+/* MODULE Flash */
+
+#include <string.h>
+
+#include "Flash.h"
+
+// Size of the data sector
+#define FLASH_SIZE_BYTES 8
+
+// The data sector - erased Flash reads as all ones
+static uint8_t Sector[FLASH_SIZE_BYTES] __attribute__ ((aligned(8)));
+
+// Map of used locations in flash memory - TRUE if used, FALSE if free
+static bool UsedFlashMap[FLASH_SIZE_BYTES];
+
+/*! @brief Checks that an address lies in the data sector and is aligned to the size of the write.
+ *
+ */
+static bool InSector(volatile const void* const address, const uint8_t size)
+{
+  const uint8_t* byte = (const uint8_t*)address;
+
+  return (byte >= Sector) && (byte + size <= Sector + FLASH_SIZE_BYTES) && (((byte - Sector) % size) == 0);
+}
+
+bool Flash_Init(void)
+{
+  memset(UsedFlashMap, false, FLASH_SIZE_BYTES);
+  memset(Sector, 0xFF, FLASH_SIZE_BYTES);
+  return true;
+}
+
+bool Flash_AllocateVar(volatile void** variable, const uint8_t size)
+{
+  if ((size != 1) && (size != 2) && (size != 4))
+    return false;
+
+  // Same placement as on the target - the first free location aligned to the size
+  for (uint8_t i = 0; i < FLASH_SIZE_BYTES; i += size)
+  {
+    bool free = true;
+
+    for (uint8_t j = 0; j < size; j++)
+      free &= !UsedFlashMap[i + j];
+
+    if (free)
+    {
+      memset(&UsedFlashMap[i], true, size);
+      *variable = &Sector[i];
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Flash_Write32(volatile uint32_t* const address, const uint32_t data)
+{
+  if (!InSector(address, 4))
+    return false;
+
+  *address = data;
+  return true;
+}
+
+bool Flash_Write16(volatile uint16_t* const address, const uint16_t data)
+{
+  if (!InSector(address, 2))
+    return false;
+
+  *address = data;
+  return true;
+}
+
+bool Flash_Write8(volatile uint8_t* const address, const uint8_t data)
+{
+  if (!InSector(address, 1))
+    return false;
+
+  *address = data;
+  return true;
+}
+
+bool Flash_Erase(void)
+{
+  memset(Sector, 0xFF, FLASH_SIZE_BYTES);
+  return true;
+}
+
+/*!
+** @}
+*/
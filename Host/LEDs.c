@@ -0,0 +1,68 @@
+/*! @file
+ *
+ *  @brief Routines to access the LEDs on the TWR-K70F120M.
+ *
+ *  Host build - the LEDs are a bit mask, and each change is written to the file named by LEDS_OUTPUT if set.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup LEDs_module LEDs module documentation
+**  @{
+*/
+/* MODULE LEDs */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "LEDs.h"
+#include "OS.h"
+
+static volatile uint32_t State;
+static FILE* Output;
+
+/*! @brief Records a change of the LEDs.
+ *
+ */
+static void Changed(void)
+{
+  if (Output)
+  {
+    fprintf(Output, "%u 0x%08x\n", (unsigned)OS_TimeGet(), (unsigned)State);
+    fflush(Output);
+  }
+}
+
+bool LEDs_Init(void)
+{
+  const char* path = getenv("LEDS_OUTPUT");
+
+  State = 0;
+  if (path && !Output)
+    Output = fopen(path, "w");
+
+  return true;
+}
+
+void LEDs_On(const LED_t color)
+{
+  State |= color;
+  Changed();
+}
+
+void LEDs_Off(const LED_t color)
+{
+  State &= ~color;
+  Changed();
+}
+
+void LEDs_Toggle(const LED_t color)
+{
+  State ^= color;
+  Changed();
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,535 @@
+/*! @file
+ *
+ *  @brief Routines to implement a simple real-time operating system (RTOS).
+ *
+ *  Host build of libOS on POSIX threads, so the firmware threads can be run and profiled on Linux.
+ *
+ *  Every OS thread is a pthread, but only the one that holds the emulated CPU runs. Whenever a thread
+ *  calls the OS, the CPU is handed to the highest priority ready thread, exactly as the libOS scheduler
+ *  would pick it. Interrupts are threads that bracket their work with OS_ISREnter() and OS_ISRExit();
+ *  a thread they make ready only takes the CPU when the running thread next calls the OS, or straight
+ *  away if the CPU was idle.
+ *
+ *  OS_HostWaitForInterrupt lets the idle thread's Sleep_Wait stand-in block until an interrupt, as WFI does.
+ *
+ *  Every switch is reported to Monitor_ContextSwitch with the outgoing thread's firmware stack, as the
+ *  PendSV vector does on the target, so the CPU load commands work.
+ *
+ *  Set OS_RUN_TICKS to stop the program after that many ticks, e.g. when running under perf.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup OS_module OS module documentation
+**  @{
+*/
+/* MODULE OS */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "OS.h"
+#include "LEDs.h"
+#include "Monitor.h"
+
+// Length of a tick - the same 10 ms as the SysTick in libOS
+#define TICK_NS 10000000L
+// Ticks between toggles of the orange LED, when asked for in OS_Init
+#define LED_TOGGLE_TICKS 50
+
+// Priority of the idle thread, which is not a real thread here
+#define IDLE_PRIORITY OS_LOWEST_PRIORITY
+// Value of Self for threads that are not OS threads, i.e. main() and interrupts
+#define NO_THREAD 0xFF
+
+/*!
+ * @struct TTCB
+ * @brief Thread control block.
+ */
+typedef struct
+{
+  OS_STATE state;                 /*!< What the thread is waiting for */
+  bool created;                   /*!< TRUE from OS_ThreadCreate until the thread is deleted */
+  pthread_t thread;               /*!< The pthread running the OS thread */
+  pthread_cond_t cpu;             /*!< Signalled when the thread is given the CPU */
+  void (*function)(void*);        /*!< The thread function */
+  void* data;                     /*!< The argument for the thread function */
+  void* stack;                    /*!< The firmware's stack for it, which is only used to identify it */
+  OS_ECB* event;                  /*!< The semaphore being waited on */
+  uint32_t delay;                 /*!< Ticks left to wait, or 0 for forever */
+  OS_ERROR result;                /*!< Result of the wait */
+} TTCB;
+
+// Protects everything below - the emulated CPU is handed over while holding it
+static pthread_mutex_t KernelLock = PTHREAD_MUTEX_INITIALIZER;
+// Held while "interrupts are disabled" and while an interrupt thread runs
+static pthread_mutex_t InterruptLock;
+
+static TTCB TCBs[IDLE_PRIORITY];
+// Bit n set if the thread at priority n is ready to run
+static uint32_t ReadyList;
+// Priority of the thread holding the CPU, or NO_THREAD if it is idle
+static uint8_t Running = NO_THREAD;
+static bool Started;
+static bool ToggleLED;
+
+static OS_ECB ECBs[OS_MAX_EVENTS];
+static uint8_t NbECBs;
+
+static volatile uint32_t Ticks;
+
+// Priority of the calling OS thread
+static __thread uint8_t Self = NO_THREAD;
+// Nesting of OS_DisableInterrupts / EnterCritical in the calling thread
+static __thread uint32_t CriticalNesting;
+// TRUE between OS_ISREnter and OS_ISRExit
+static __thread bool InISR;
+// Exception number of the interrupt being run, or 0 if it is not known
+static __thread uint8_t Vector;
+
+// Signalled at the end of every interrupt, for OS_HostWaitForInterrupt
+static pthread_cond_t Interrupted = PTHREAD_COND_INITIALIZER;
+static uint32_t NbInterrupts;
+static uint8_t LastVector;
+
+// Exception number of the SysTick
+#define SYSTICK_VECTOR 15
+
+/*! @brief Gives the CPU to the highest priority ready thread.
+ *
+ *  @note Must be called with KernelLock held.
+ */
+static void Schedule(void)
+{
+  uint8_t next;
+
+  if (!Started)
+    return;
+
+  next = ReadyList ? (uint8_t)__builtin_ctz(ReadyList) : NO_THREAD;
+  if (next == Running)
+    return;
+
+  Monitor_ContextSwitch((Running != NO_THREAD) ? TCBs[Running].stack : NULL);
+
+  Running = next;
+  if (next != NO_THREAD)
+    pthread_cond_signal(&TCBs[next].cpu);
+}
+
+/*! @brief Lets a higher priority thread take over at an OS call, and waits for the CPU if the caller blocked.
+ *
+ *  @note Must be called with KernelLock held.
+ */
+static void Reschedule(void)
+{
+  // Interrupts never give up the CPU; they can only hand it out if nothing was running
+  if (Self == NO_THREAD)
+  {
+    if (Running == NO_THREAD)
+      Schedule();
+    return;
+  }
+
+  // With interrupts disabled the switch waits until they are enabled again
+  if ((CriticalNesting > 0) && (ReadyList & (1u << Self)))
+    return;
+
+  Schedule();
+  while (Running != Self)
+    pthread_cond_wait(&TCBs[Self].cpu, &KernelLock);
+}
+
+/*! @brief Makes a thread ready to run.
+ *
+ *  @param priority The thread's priority.
+ *  @param result What its wait returns.
+ *  @note Must be called with KernelLock held.
+ */
+static void MakeReady(const uint8_t priority, const OS_ERROR result)
+{
+  TTCB* tcb = &TCBs[priority];
+
+  tcb->state = OS_STATE_READY;
+  tcb->delay = 0;
+  tcb->result = result;
+  ReadyList |= (1u << priority);
+}
+
+/*! @brief Starts an OS thread once it has been given the CPU.
+ *
+ */
+static void* ThreadEntry(void* arg)
+{
+  TTCB* tcb = (TTCB*)arg;
+
+  Self = (uint8_t)(tcb - TCBs);
+
+  pthread_mutex_lock(&KernelLock);
+  while (Running != Self)
+    pthread_cond_wait(&tcb->cpu, &KernelLock);
+  pthread_mutex_unlock(&KernelLock);
+
+  tcb->function(tcb->data);
+
+  // Returning from a thread deletes it
+  (void)OS_ThreadDelete(OS_PRIORITY_SELF);
+  return NULL;
+}
+
+/*! @brief Emulates the SysTick interrupt.
+ *
+ */
+static void* TickThread(void* arg)
+{
+  struct timespec next;
+
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  for (;;)
+  {
+    next.tv_nsec += TICK_NS;
+    if (next.tv_nsec >= 1000000000L)
+    {
+      next.tv_nsec -= 1000000000L;
+      next.tv_sec++;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) != 0);
+
+    OS_ISREnter();
+    Vector = SYSTICK_VECTOR;
+    pthread_mutex_lock(&KernelLock);
+
+    Ticks++;
+
+    for (uint8_t priority = 0; priority < IDLE_PRIORITY; priority++)
+    {
+      TTCB* tcb = &TCBs[priority];
+
+      if (((tcb->state != OS_STATE_DELAYED) && (tcb->state != OS_STATE_SEMAPHORE)) || (tcb->delay == 0))
+        continue;
+
+      if (--tcb->delay == 0)
+      {
+        if (tcb->state == OS_STATE_SEMAPHORE)
+        {
+          tcb->event->waitList &= ~(1u << priority);
+          MakeReady(priority, OS_TIMEOUT);
+        }
+        else
+        {
+          MakeReady(priority, OS_NO_ERROR);
+        }
+      }
+    }
+
+    pthread_mutex_unlock(&KernelLock);
+
+    if (ToggleLED && ((Ticks % LED_TOGGLE_TICKS) == 0))
+      LEDs_Toggle(LED_ORANGE);
+
+    OS_ISRExit();
+  }
+
+  return NULL;
+}
+
+void OS_Init(const uint32_t cpuCoreClk, const bool toggleLED)
+{
+  pthread_mutexattr_t attributes;
+
+  (void)cpuCoreClk;
+  ToggleLED = toggleLED;
+
+  // Interrupt disabling nests
+  pthread_mutexattr_init(&attributes);
+  pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&InterruptLock, &attributes);
+  pthread_mutexattr_destroy(&attributes);
+
+  for (uint8_t priority = 0; priority < IDLE_PRIORITY; priority++)
+  {
+    pthread_cond_init(&TCBs[priority].cpu, NULL);
+    TCBs[priority].state = OS_STATE_DORMANT;
+    TCBs[priority].created = false;
+  }
+}
+
+void OS_ISREnter(void)
+{
+  pthread_mutex_lock(&InterruptLock);
+  InISR = true;
+  Vector = 0;
+}
+
+void OS_ISRExit(void)
+{
+  pthread_mutex_lock(&KernelLock);
+  NbInterrupts++;
+  LastVector = Vector;
+  pthread_cond_broadcast(&Interrupted);
+  Reschedule();
+  pthread_mutex_unlock(&KernelLock);
+
+  InISR = false;
+  pthread_mutex_unlock(&InterruptLock);
+}
+
+void OS_HostDisableInterrupts(void)
+{
+  pthread_mutex_lock(&InterruptLock);
+  CriticalNesting++;
+}
+
+void OS_HostEnableInterrupts(void)
+{
+  if (CriticalNesting == 0)
+    return;
+
+  CriticalNesting--;
+  pthread_mutex_unlock(&InterruptLock);
+
+  // Make any switch that was held off while interrupts were disabled
+  if ((CriticalNesting == 0) && (Self != NO_THREAD))
+  {
+    pthread_mutex_lock(&KernelLock);
+    Reschedule();
+    pthread_mutex_unlock(&KernelLock);
+  }
+}
+
+uint8_t OS_HostWaitForInterrupt(void)
+{
+  uint32_t nesting = CriticalNesting;
+  uint32_t seen;
+  uint8_t vector;
+
+  pthread_mutex_lock(&KernelLock);
+  seen = NbInterrupts;
+
+  // On the target the interrupt stays pending until they are enabled; here it has to run to be seen
+  for (uint32_t level = 0; level < nesting; level++)
+    pthread_mutex_unlock(&InterruptLock);
+
+  while (NbInterrupts == seen)
+    pthread_cond_wait(&Interrupted, &KernelLock);
+  vector = LastVector;
+
+  pthread_mutex_unlock(&KernelLock);
+
+  for (uint32_t level = 0; level < nesting; level++)
+    pthread_mutex_lock(&InterruptLock);
+
+  return vector;
+}
+
+OS_ECB* OS_SemaphoreCreate(const uint32_t value)
+{
+  OS_ECB* semaphore = NULL;
+
+  pthread_mutex_lock(&KernelLock);
+  if (NbECBs < OS_MAX_EVENTS)
+  {
+    semaphore = &ECBs[NbECBs++];
+    semaphore->count = value;
+    semaphore->waitList = 0;
+  }
+  pthread_mutex_unlock(&KernelLock);
+
+  return semaphore;
+}
+
+OS_ERROR OS_SemaphoreSignal(OS_ECB* const pEvent)
+{
+  OS_ERROR error = OS_NO_ERROR;
+
+  pthread_mutex_lock(&KernelLock);
+
+  if (pEvent->waitList)
+  {
+    // The highest priority waiter gets it
+    uint8_t priority = (uint8_t)__builtin_ctz(pEvent->waitList);
+
+    pEvent->waitList &= ~(1u << priority);
+    MakeReady(priority, OS_NO_ERROR);
+  }
+  else if (pEvent->count == UINT32_MAX)
+  {
+    error = OS_SEMAPHORE_OVERFLOW;
+  }
+  else
+  {
+    pEvent->count++;
+  }
+
+  Reschedule();
+  pthread_mutex_unlock(&KernelLock);
+
+  return error;
+}
+
+OS_ERROR OS_SemaphoreWait(OS_ECB* const pEvent, const uint32_t timeout)
+{
+  TTCB* tcb;
+  OS_ERROR error;
+
+  pthread_mutex_lock(&KernelLock);
+
+  if (pEvent->count > 0)
+  {
+    pEvent->count--;
+    Reschedule();
+    pthread_mutex_unlock(&KernelLock);
+    return OS_NO_ERROR;
+  }
+
+  // Only threads can wait
+  if (Self == NO_THREAD)
+  {
+    pthread_mutex_unlock(&KernelLock);
+    return OS_TIMEOUT;
+  }
+
+  tcb = &TCBs[Self];
+  tcb->state = OS_STATE_SEMAPHORE;
+  tcb->event = pEvent;
+  tcb->delay = timeout;
+  pEvent->waitList |= (1u << Self);
+  ReadyList &= ~(1u << Self);
+
+  Reschedule();
+
+  error = tcb->result;
+  pthread_mutex_unlock(&KernelLock);
+
+  return error;
+}
+
+void OS_Start(void)
+{
+  pthread_t tick;
+  const char* runTicks = getenv("OS_RUN_TICKS");
+  uint32_t stopTicks = runTicks ? (uint32_t)strtoul(runTicks, NULL, 0) : 0;
+  const struct timespec tickLength = {0, TICK_NS};
+
+  pthread_mutex_lock(&KernelLock);
+  if (Started)
+  {
+    pthread_mutex_unlock(&KernelLock);
+    return;
+  }
+  Started = true;
+  Schedule();
+  pthread_mutex_unlock(&KernelLock);
+
+  pthread_create(&tick, NULL, TickThread, NULL);
+
+  // main() becomes the idle thread
+  for (;;)
+  {
+    nanosleep(&tickLength, NULL);
+    if (stopTicks && (Ticks >= stopTicks))
+      exit(EXIT_SUCCESS);
+  }
+}
+
+OS_ERROR OS_ThreadCreate(void (*thread)(void* pd), void* pData, void* pStack, const uint8_t priority)
+{
+  TTCB* tcb;
+
+  if (priority >= IDLE_PRIORITY)
+    return OS_PRIORITY_INVALID;
+
+  pthread_mutex_lock(&KernelLock);
+
+  tcb = &TCBs[priority];
+  if (tcb->created)
+  {
+    pthread_mutex_unlock(&KernelLock);
+    return OS_PRIORITY_EXISTS;
+  }
+
+  tcb->created = true;
+  tcb->function = thread;
+  tcb->data = pData;
+  tcb->stack = pStack;
+  if (pthread_create(&tcb->thread, NULL, ThreadEntry, tcb) != 0)
+  {
+    tcb->created = false;
+    pthread_mutex_unlock(&KernelLock);
+    return OS_NO_MORE_TCBS;
+  }
+  pthread_detach(tcb->thread);
+
+  MakeReady(priority, OS_NO_ERROR);
+  Reschedule();
+
+  pthread_mutex_unlock(&KernelLock);
+
+  return OS_NO_ERROR;
+}
+
+OS_ERROR OS_ThreadDelete(uint8_t priority)
+{
+  if (InISR)
+    return OS_THREAD_DELETE_ISR;
+
+  if (priority == OS_PRIORITY_SELF)
+    priority = Self;
+
+  if (priority == IDLE_PRIORITY)
+    return OS_THREAD_DELETE_IDLE;
+
+  if (priority > IDLE_PRIORITY)
+    return OS_PRIORITY_INVALID;
+
+  // A pthread cannot be stopped safely from outside, so threads can only delete themselves here
+  if (priority != Self)
+    return OS_THREAD_DELETE_ERROR;
+
+  pthread_mutex_lock(&KernelLock);
+  TCBs[priority].created = false;
+  TCBs[priority].state = OS_STATE_DORMANT;
+  ReadyList &= ~(1u << priority);
+  Schedule();
+  pthread_mutex_unlock(&KernelLock);
+
+  pthread_exit(NULL);
+}
+
+void OS_TimeDelay(const uint32_t ticks)
+{
+  TTCB* tcb;
+
+  if ((ticks == 0) || (Self == NO_THREAD))
+    return;
+
+  pthread_mutex_lock(&KernelLock);
+
+  tcb = &TCBs[Self];
+  tcb->state = OS_STATE_DELAYED;
+  tcb->delay = ticks;
+  ReadyList &= ~(1u << Self);
+
+  Reschedule();
+
+  pthread_mutex_unlock(&KernelLock);
+}
+
+uint32_t OS_TimeGet(void)
+{
+  return Ticks;
+}
+
+void OS_TimeSet(const uint32_t ticks)
+{
+  pthread_mutex_lock(&KernelLock);
+  Ticks = ticks;
+  pthread_mutex_unlock(&KernelLock);
+}
+
+/*!
+** @}
+*/
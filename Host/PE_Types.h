@@ -0,0 +1,27 @@
+/*! @file
+ *
+ *  @brief Basic types and hardware specific macros for the host build.
+ *
+ *  Stands in for the Processor Expert PE_Types.h, whose critical section macros are Cortex-M assembly.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef __PE_Types_H
+#define __PE_Types_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "OS.h"
+
+// Critical sections nest, and hold off the threads that emulate interrupts
+#define EnterCritical() OS_HostDisableInterrupts()
+#define ExitCritical()  OS_HostEnableInterrupts()
+
+#define PE_NOP()
+#define PE_WFI()
+
+#endif
@@ -0,0 +1,204 @@
+/*! @file
+ *
+ *  @brief Routines for controlling the Periodic Interrupt Timer (PIT).
+ *
+ *  Host build - a thread per channel waits out each period on the monotonic clock and then runs the
+ *  channel's interrupt.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup PIT_module PIT module documentation
+**  @{
+*/
+/* MODULE PIT */
+
+#include <pthread.h>
+#include <time.h>
+
+#include "PIT.h"
+#include "OS.h"
+
+/*!
+ * @struct TPITChannel
+ */
+typedef struct
+{
+  pthread_cond_t changed;           /*!< Signalled when the channel is set, enabled or disabled */
+  pthread_t timer;                  /*!< Waits out the periods */
+  bool timerStarted;
+  uint32_t period;                  /*!< In ns */
+  bool enabled;                     /*!< TRUE while the channel is counting */
+  uint32_t restarts;                /*!< Bumped when a fresh period starts */
+  void (*callback)(void*);          /*!< Called at each expiry, or NULL */
+  void* arguments;                  /*!< For the callback */
+} TPITChannel;
+
+// Protects the channels
+static pthread_mutex_t Lock = PTHREAD_MUTEX_INITIALIZER;
+static TPITChannel Channels[PIT_NB_CHANNELS];
+
+// Signalled at each expiry of the channel
+OS_ECB* PITSemaphores[PIT_NB_CHANNELS];
+
+static void (* const ISRs[PIT_NB_CHANNELS])(void) = {PIT0_ISR, PIT1_ISR, PIT2_ISR, PIT3_ISR};
+
+/*! @brief Emulates one channel's counter.
+ *
+ */
+static void* TimerThread(void* arg)
+{
+  const uint8_t channelNb = (uint8_t)(uintptr_t)arg;
+  TPITChannel* channel = &Channels[channelNb];
+  struct timespec last, next;
+  uint32_t restarts = 0;
+
+  pthread_mutex_lock(&Lock);
+  for (;;)
+  {
+    while (!channel->enabled || (channel->period == 0))
+      pthread_cond_wait(&channel->changed, &Lock);
+
+    if (restarts != channel->restarts)
+    {
+      restarts = channel->restarts;
+      clock_gettime(CLOCK_MONOTONIC, &last);
+    }
+
+    // Periods follow on from the last expiry, so they do not drift
+    next = last;
+    next.tv_nsec += channel->period;
+    while (next.tv_nsec >= 1000000000L)
+    {
+      next.tv_nsec -= 1000000000L;
+      next.tv_sec++;
+    }
+
+    // Count down the period, starting again if the channel is changed
+    if (pthread_cond_timedwait(&channel->changed, &Lock, &next) == 0)
+      continue;
+
+    last = next;
+    pthread_mutex_unlock(&Lock);
+    ISRs[channelNb]();
+    pthread_mutex_lock(&Lock);
+  }
+
+  return NULL;
+}
+
+bool PIT_Init(const uint32_t moduleClk)
+{
+  (void)moduleClk;
+
+  return true;
+}
+
+bool PIT_ChannelInit(const uint8_t channelNb, void (*userFunction)(void*), void* userArguments)
+{
+  TPITChannel* channel;
+  pthread_condattr_t attributes;
+  bool started;
+
+  if (channelNb >= PIT_NB_CHANNELS)
+    return false;
+
+  channel = &Channels[channelNb];
+
+  pthread_mutex_lock(&Lock);
+  channel->callback = userFunction;
+  channel->arguments = userArguments;
+  started = channel->timerStarted;
+  pthread_mutex_unlock(&Lock);
+
+  if (!PITSemaphores[channelNb])
+    PITSemaphores[channelNb] = OS_SemaphoreCreate(0);
+
+  if (!started)
+  {
+    // The periods are timed on the monotonic clock
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&channel->changed, &attributes);
+    pthread_condattr_destroy(&attributes);
+
+    channel->timerStarted = (pthread_create(&channel->timer, NULL, TimerThread, (void*)(uintptr_t)channelNb) == 0);
+  }
+
+  return channel->timerStarted && (PITSemaphores[channelNb] != NULL);
+}
+
+void PIT_Set(const uint8_t channelNb, const uint32_t period, const bool restart)
+{
+  TPITChannel* channel;
+
+  if (channelNb >= PIT_NB_CHANNELS)
+    return;
+
+  channel = &Channels[channelNb];
+
+  pthread_mutex_lock(&Lock);
+  channel->period = period;
+  if (restart || !channel->enabled)
+    channel->restarts++;
+  channel->enabled = true;
+  pthread_cond_signal(&channel->changed);
+  pthread_mutex_unlock(&Lock);
+}
+
+void PIT_Enable(const uint8_t channelNb, const bool enable)
+{
+  TPITChannel* channel;
+
+  if (channelNb >= PIT_NB_CHANNELS)
+    return;
+
+  channel = &Channels[channelNb];
+
+  pthread_mutex_lock(&Lock);
+  if (enable && !channel->enabled)
+    channel->restarts++;
+  channel->enabled = enable;
+  pthread_cond_signal(&channel->changed);
+  pthread_mutex_unlock(&Lock);
+}
+
+/*! @brief Handles an expiry of a channel.
+ *
+ */
+static void Expired(const uint8_t channelNb)
+{
+  OS_ISREnter();
+
+  if (Channels[channelNb].callback)
+    Channels[channelNb].callback(Channels[channelNb].arguments);
+
+  OS_SemaphoreSignal(PITSemaphores[channelNb]);
+
+  OS_ISRExit();
+}
+
+void __attribute__ ((interrupt)) PIT0_ISR(void)
+{
+  Expired(0);
+}
+
+void __attribute__ ((interrupt)) PIT1_ISR(void)
+{
+  Expired(1);
+}
+
+void __attribute__ ((interrupt)) PIT2_ISR(void)
+{
+  Expired(2);
+}
+
+void __attribute__ ((interrupt)) PIT3_ISR(void)
+{
+  Expired(3);
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,31 @@
+/*! @file
+ *
+ *  @brief Routines for putting the Cortex-M4 core to sleep.
+ *
+ *  Host build - sleeping blocks the idle thread until one of the emulated interrupts has run.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Sleep_module Sleep module documentation
+**  @{
+*/
+/* MODULE Sleep */
+
+#include "Sleep.h"
+#include "OS.h"
+
+bool Sleep_Init(void)
+{
+  return true;
+}
+
+uint8_t Sleep_Wait(void)
+{
+  return OS_HostWaitForInterrupt();
+}
+
+/*!
+** @}
+*/
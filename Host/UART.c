@@ -0,0 +1,258 @@
+/*! @file
+ *
+ *  @brief I/O routines for UART communications on the TWR-K70F120M.
+ *
+ *  Host build - the serial port is a pseudo-terminal, so the PC software can open it like the tower's
+ *  USB serial port. Its name is printed on start up, and it is also linked to UART_LINK if that is set.
+ *  Transmission finishes as soon as the bytes are written, and the baud rate is only checked and recorded.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup UART_module UART module documentation
+**  @{
+*/
+/* MODULE UART */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "UART.h"
+#include "OS.h"
+#include "packet.h"
+
+// Size of the receive ring - must be a power of 2 so the indices can wrap by masking
+#define RX_RING_SIZE 256
+
+const uint8_t BAUD_MULTIPLIER = 32;
+
+// Largest value of the 13-bit SBR field
+#define SBR_MAX 0x1FFF
+
+/*!
+ * @struct RxRing_t
+ * @brief Single producer (the receive thread), single consumer (UART_InChar) receive ring.
+ */
+typedef struct
+{
+  volatile uint16_t Head;             /*!< Free-running count of bytes written */
+  volatile uint16_t Tail;             /*!< Free-running count of bytes read */
+  volatile uint16_t Overruns;         /*!< Number of bytes dropped because the ring was full */
+  uint8_t Buffer[RX_RING_SIZE];       /*!< The actual array of bytes to store the data */
+} RxRing_t;
+
+static RxRing_t RxRing;
+
+// Master side of the pseudo-terminal
+static int Port = -1;
+// Slave side, held open so the port keeps working while no PC software has it open
+static int PortSlave = -1;
+static pthread_t Receiver;
+
+static uint32_t BaudRate;
+
+extern OS_ECB* Packet_ByteReady;
+
+/*! @brief Emulates the UART receive interrupt.
+ *
+ */
+static void* ReceiveThread(void* arg)
+{
+  struct pollfd port = {.fd = Port, .events = POLLIN};
+  uint8_t data[RX_RING_SIZE];
+  ssize_t count;
+
+  for (;;)
+  {
+    if (poll(&port, 1, -1) <= 0)
+      continue;
+
+    count = read(Port, data, sizeof(data));
+    if (count <= 0)
+    {
+      // Nothing to read until the PC software opens the port again
+      if ((count < 0) && (errno != EAGAIN) && (errno != EINTR))
+        usleep(10000);
+      continue;
+    }
+
+    OS_ISREnter();
+
+    for (ssize_t i = 0; i < count; i++)
+    {
+      uint16_t head = RxRing.Head;
+
+      if ((uint16_t)(head - RxRing.Tail) >= RX_RING_SIZE)
+      {
+        RxRing.Overruns++;
+        continue;
+      }
+
+      RxRing.Buffer[head & (RX_RING_SIZE - 1)] = data[i];
+      __atomic_store_n(&RxRing.Head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    // One wakeup per burst, as on the target
+    (void)OS_SemaphoreSignal(Packet_ByteReady);
+
+    OS_ISRExit();
+  }
+
+  return NULL;
+}
+
+/*! @brief Calculates the baud rate divisor, with the same limits as the K70 baud rate generator.
+ *
+ *  @param baudRate The desired baud rate in bits/sec.
+ *  @param moduleClk The module clock rate in Hz.
+ *  @return bool - TRUE if the divisor fits in SBR and BRFA and is accurate enough.
+ */
+static bool BaudDivisorValid(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  uint32_t divisor, actual, error;
+
+  if (baudRate == 0)
+    return false;
+
+  divisor = ((2 * moduleClk) + (baudRate / 2)) / baudRate;
+  if ((divisor < BAUD_MULTIPLIER) || (divisor > ((SBR_MAX + 1) * BAUD_MULTIPLIER - 1)))
+    return false;
+
+  actual = (2 * moduleClk) / divisor;
+  error = (actual > baudRate) ? (actual - baudRate) : (baudRate - actual);
+
+  return (error * 100) <= (baudRate * UART_MAX_BAUD_ERROR);
+}
+
+bool UART_BaudRateValid(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  return BaudDivisorValid(baudRate, moduleClk);
+}
+
+bool UART_SetBaudRate(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  if (!BaudDivisorValid(baudRate, moduleClk))
+    return false;
+
+  BaudRate = baudRate;
+  return true;
+}
+
+uint32_t UART_GetBaudRate(void)
+{
+  return BaudRate;
+}
+
+bool UART_TxIdle(void)
+{
+  return true;
+}
+
+bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  struct termios settings;
+  const char* link = getenv("UART_LINK");
+
+  RxRing.Head = 0;
+  RxRing.Tail = 0;
+  RxRing.Overruns = 0;
+
+  if (!UART_SetBaudRate(baudRate, moduleClk))
+    return false;
+
+  if (Port >= 0)
+    return true;
+
+  Port = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if ((Port < 0) || (grantpt(Port) != 0) || (unlockpt(Port) != 0))
+    return false;
+
+  // Raw bytes in both directions
+  PortSlave = open(ptsname(Port), O_RDWR | O_NOCTTY);
+  if ((PortSlave < 0) || (tcgetattr(PortSlave, &settings) != 0))
+    return false;
+  cfmakeraw(&settings);
+  (void)tcsetattr(PortSlave, TCSANOW, &settings);
+
+  fprintf(stderr, "UART on %s\n", ptsname(Port));
+  if (link)
+  {
+    (void)unlink(link);
+    if (symlink(ptsname(Port), link) != 0)
+      perror(link);
+  }
+
+  return (pthread_create(&Receiver, NULL, ReceiveThread, NULL) == 0);
+}
+
+bool UART_InChar(uint8_t * const dataPtr)
+{
+  uint16_t tail = RxRing.Tail;
+
+  if (tail == __atomic_load_n(&RxRing.Head, __ATOMIC_ACQUIRE))
+    return false;
+
+  *dataPtr = RxRing.Buffer[tail & (RX_RING_SIZE - 1)];
+  __atomic_store_n(&RxRing.Tail, tail + 1, __ATOMIC_RELEASE);
+
+  return true;
+}
+
+uint16_t UART_InCount(void)
+{
+  return (uint16_t)(RxRing.Head - RxRing.Tail);
+}
+
+/*! @brief Sends a frame straight away.
+ *
+ *  @return bool - TRUE if all of the frame was written, FALSE if the port's buffer is full as nobody is reading it.
+ */
+static bool Write(const uint8_t* const data, const uint16_t length)
+{
+  ssize_t written;
+
+  if ((Port < 0) || (length == 0))
+    return false;
+
+  written = write(Port, data, length);
+  return written == (ssize_t)length;
+}
+
+bool UART_OutFrame(const uint8_t* const data, const uint8_t length)
+{
+  if (length > UART_TX_FRAME_SIZE)
+    return false;
+
+  return Write(data, length);
+}
+
+bool UART_OutBuffer(const uint8_t* const data, const uint16_t length, volatile bool* const busy)
+{
+  if (!busy)
+    return false;
+
+  // The frame has gone by the time the caller could look at busy
+  *busy = false;
+  return Write(data, length);
+}
+
+bool UART_OutChar(const uint8_t data)
+{
+  return UART_OutFrame(&data, 1);
+}
+
+void UART_Poll(void)
+{
+}
+
+/*!
+** @}
+*/
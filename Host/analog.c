@@ -0,0 +1,319 @@
+/*! @file
+ *
+ *  @brief Routines for setting up and reading from the ADC.
+ *
+ *  Host build of libAnalog - the inputs play back a waveform file and the outputs are logged to a file.
+ *
+ *  ANALOG_INPUT names a text file with one line per sample and one whitespace separated column of raw
+ *  ADC counts per input channel; lines starting with '#' are skipped and the file repeats when it runs
+ *  out. ANALOG_INPUT can also name a capture file (see Capture.h), which is played back the same way.
+ *  Without it every input is a 2.5 V RMS sine of ANALOG_CYCLE_SAMPLES samples per cycle, the channels
+ *  120 degrees apart.
+ *
+ *  ANALOG_CAPTURE names a capture file that gets the first ANALOG_CAPTURE_CHANNELS inputs as they are
+ *  read, so a run can be replayed later with build/replay.
+ *
+ *  ANALOG_OUTPUT names a file that gets a "sample channel value" line whenever an output changes, where
+ *  sample is the number of samples read so far from input 0.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup analog_module analog module documentation
+**  @{
+*/
+/* MODULE analog */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "analog.h"
+#include "CaptureFile.h"
+
+// Samples per cycle of the built in sine - a 50 Hz mains cycle at the 800 Hz sample rate
+#define ANALOG_CYCLE_SAMPLES 16
+// Peak of the built in sine in ADC counts - 2.5 V RMS on the +/- 10 V range
+#define ANALOG_SINE_PEAK (3276.7 * 2.5 * M_SQRT2)
+
+// Longest line read from ANALOG_INPUT
+#define LINE_SIZE 256
+
+// Inputs written to ANALOG_CAPTURE - the three phases the firmware samples
+#define ANALOG_CAPTURE_CHANNELS 3
+// Same as the firmware's sample period and scaling
+#define ANALOG_CAPTURE_PERIOD 1250000
+#define ANALOG_CAPTURE_VOLT_PER_BIT 3276.7f
+
+typedef int16_t TSample[ANALOG_NB_INPUTS];
+
+static TSample* Samples;
+static uint32_t NbSamples;
+// Next sample to read for each input
+static uint32_t Position[ANALOG_NB_INPUTS];
+static uint32_t SampleCount;
+
+static int16_t Outputs[ANALOG_NB_OUTPUTS];
+static FILE* Output;
+
+static TCaptureFile Capture;
+// The program can exit from another thread part way through a sample
+static pthread_mutex_t CaptureLock = PTHREAD_MUTEX_INITIALIZER;
+static int16_t CaptureSample[ANALOG_CAPTURE_CHANNELS];
+
+/*! @brief Adds a sample to the waveform.
+ *
+ *  @return bool - TRUE if there was room for it.
+ */
+static bool Append(const TSample sample, uint32_t* const capacity)
+{
+  if (NbSamples == *capacity)
+  {
+    uint32_t newCapacity = *capacity ? (*capacity * 2) : 1024;
+    TSample* grown = realloc(Samples, newCapacity * sizeof(TSample));
+
+    if (!grown)
+      return false;
+
+    Samples = grown;
+    *capacity = newCapacity;
+  }
+
+  memcpy(Samples[NbSamples++], sample, sizeof(TSample));
+  return true;
+}
+
+/*! @brief Reads the waveform file.
+ *
+ *  @return bool - TRUE if at least one sample was read.
+ */
+static bool LoadWaveform(const char* const path)
+{
+  FILE* file = fopen(path, "r");
+  char line[LINE_SIZE];
+  uint32_t capacity = 0;
+
+  if (!file)
+  {
+    perror(path);
+    return false;
+  }
+
+  while (fgets(line, sizeof(line), file))
+  {
+    TSample sample = {0};
+    char* next = line;
+    bool any = false;
+
+    if (line[0] == '#')
+      continue;
+
+    for (uint8_t channelNb = 0; channelNb < ANALOG_NB_INPUTS; channelNb++)
+    {
+      char* end;
+      long value = strtol(next, &end, 0);
+
+      if (end == next)
+        break;
+
+      sample[channelNb] = (int16_t)((value > INT16_MAX) ? INT16_MAX : (value < INT16_MIN) ? INT16_MIN : value);
+      next = end;
+      any = true;
+    }
+
+    if (any && !Append(sample, &capacity))
+      break;
+  }
+
+  fclose(file);
+  return NbSamples > 0;
+}
+
+/*! @brief Reads a capture file.
+ *
+ *  @return bool - TRUE if at least one sample was read.
+ */
+static bool LoadCapture(TCaptureReader* const reader)
+{
+  int16_t channels[CAPTURE_MAX_CHANNELS][CAPTURE_FILE_CHUNK_SAMPLES];
+  int16_t* samples[CAPTURE_MAX_CHANNELS];
+  uint32_t capacity = 0;
+  uint16_t nbSamples;
+
+  for (uint8_t channelNb = 0; channelNb < CAPTURE_MAX_CHANNELS; channelNb++)
+    samples[channelNb] = channels[channelNb];
+
+  while (Capture_ReadChunk(reader, samples, CAPTURE_FILE_CHUNK_SAMPLES, &nbSamples))
+  {
+    for (uint16_t sampleNb = 0; sampleNb < nbSamples; sampleNb++)
+    {
+      TSample sample = {0};
+
+      for (uint8_t channelNb = 0; (channelNb < reader->info.nbChannels) && (channelNb < ANALOG_NB_INPUTS); channelNb++)
+        sample[channelNb] = channels[channelNb][sampleNb];
+
+      if (!Append(sample, &capacity))
+        return false;
+    }
+  }
+
+  return NbSamples > 0;
+}
+
+/*! @brief Reads the input file, a capture or text.
+ *
+ *  @return bool - TRUE if at least one sample was read.
+ */
+static bool LoadInput(const char* const path)
+{
+  TCaptureReader reader;
+  FILE* file = fopen(path, "rb");
+  char magic[4] = {0};
+  bool success;
+
+  if (!file)
+  {
+    perror(path);
+    return false;
+  }
+
+  (void)fread(magic, 1, sizeof(magic), file);
+  fclose(file);
+
+  if (memcmp(magic, "ACAP", sizeof(magic)) != 0)
+    return LoadWaveform(path);
+
+  if (!CaptureFile_Map(path, &reader))
+    return false;
+
+  success = LoadCapture(&reader);
+  CaptureFile_Unmap(&reader);
+
+  return success;
+}
+
+/*! @brief Finishes the capture file when the program exits.
+ *
+ */
+static void CloseCapture(void)
+{
+  pthread_mutex_lock(&CaptureLock);
+  (void)CaptureFile_Close(&Capture);
+  pthread_mutex_unlock(&CaptureLock);
+}
+
+/*! @brief Starts the capture file.
+ *
+ */
+static void OpenCapture(const char* const path)
+{
+  const TCaptureInfo info =
+  {
+    .nbChannels = ANALOG_CAPTURE_CHANNELS,
+    .samplePeriod = ANALOG_CAPTURE_PERIOD,
+    .voltPerBit = ANALOG_CAPTURE_VOLT_PER_BIT
+  };
+
+  if (CaptureFile_Create(&Capture, path, &info, CAPTURE_ENCODING_DELTA))
+    atexit(CloseCapture);
+}
+
+/*! @brief Builds the built in three phase sine.
+ *
+ */
+static bool BuildSine(void)
+{
+  uint32_t capacity = 0;
+
+  for (uint8_t sampleNb = 0; sampleNb < ANALOG_CYCLE_SAMPLES; sampleNb++)
+  {
+    TSample sample = {0};
+
+    for (uint8_t channelNb = 0; channelNb < 3; channelNb++)
+    {
+      double phase = 2 * M_PI * ((double)sampleNb / ANALOG_CYCLE_SAMPLES - channelNb / 3.0);
+      sample[channelNb] = (int16_t)lround(ANALOG_SINE_PEAK * sin(phase));
+    }
+
+    if (!Append(sample, &capacity))
+      return false;
+  }
+
+  return true;
+}
+
+bool Analog_Init(const uint32_t moduleClock)
+{
+  const char* input = getenv("ANALOG_INPUT");
+  const char* output = getenv("ANALOG_OUTPUT");
+  const char* capture = getenv("ANALOG_CAPTURE");
+
+  (void)moduleClock;
+
+  if (!Samples && !(input ? LoadInput(input) : BuildSine()))
+    return false;
+
+  memset(Position, 0, sizeof(Position));
+  SampleCount = 0;
+
+  if (output && !Output)
+  {
+    Output = fopen(output, "w");
+    if (!Output)
+      perror(output);
+  }
+
+  if (capture && !Capture.file)
+    OpenCapture(capture);
+
+  return true;
+}
+
+bool Analog_Get(const uint8_t channelNb, int16_t* const valuePtr)
+{
+  if ((channelNb >= ANALOG_NB_INPUTS) || !Samples)
+    return false;
+
+  *valuePtr = Samples[Position[channelNb]][channelNb];
+  if (++Position[channelNb] == NbSamples)
+    Position[channelNb] = 0;
+
+  if (channelNb == 0)
+    SampleCount++;
+
+  // A sample of every captured channel is written once the last of them has been read
+  if (Capture.file && (channelNb < ANALOG_CAPTURE_CHANNELS))
+  {
+    CaptureSample[channelNb] = *valuePtr;
+    if (channelNb == ANALOG_CAPTURE_CHANNELS - 1)
+    {
+      pthread_mutex_lock(&CaptureLock);
+      (void)CaptureFile_Append(&Capture, CaptureSample);
+      pthread_mutex_unlock(&CaptureLock);
+    }
+  }
+
+  return true;
+}
+
+bool Analog_Put(uint8_t const channelNb, int16_t const value)
+{
+  if (channelNb >= ANALOG_NB_OUTPUTS)
+    return false;
+
+  if ((value != Outputs[channelNb]) && Output)
+  {
+    fprintf(Output, "%u %u %d\n", (unsigned)SampleCount, (unsigned)channelNb, (int)value);
+    fflush(Output);
+  }
+  Outputs[channelNb] = value;
+
+  return true;
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,553 @@
+/*! @file
+ *
+ *  @brief Micro-benchmarks of the DSP, protocol and FIFO kernels.
+ *
+ *  Times RMS_CalculateAll, VRR_CalcDeviation, Frequency_isZeroCrossing, Frequency_Update, the regulation
+ *  pipeline, Packet_Get, Packet_Put, FIFO_Put and FIFO_Get on the host, over several window sizes and input distributions. The UART and libOS are
+ *  replaced by the stand-ins at the end of this file, which do as little as possible, so the numbers
+ *  are the firmware code's own cost.
+ *
+ *    build/bench [-t seconds] [-o results.json] [name]
+ *
+ *  Each case is run until it has taken at least -t seconds (0.2 by default), BENCH_RUNS times, and the
+ *  fastest run is kept. A table goes to stderr and the results go to -o, or stdout, as JSON:
+ *
+ *    {"suite": "host", "version": 1, "compiler": "...", "results": [
+ *      {"name": "rms", "size": 16, "distribution": "sine", "unit": "samples",
+ *       "ns_per_op": 21.3, "ops_per_s": 4.69e7, "items_per_s": 7.5e8}, ...]}
+ *
+ *  An op is one call of the kernel on size items, e.g. one RMS_CalculateAll of a 16 sample window of every channel or one
+ *  Packet_Get loop over 64 packets, and items_per_s is the throughput in the case's unit. Only the
+ *  cases whose name starts with the name given are run.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup bench_module bench module documentation
+**  @{
+*/
+/* MODULE bench */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Cpu.h"
+#include "FIFO.h"
+#include "Frequency.h"
+#include "OS.h"
+#include "RMS.h"
+#include "Regulator.h"
+#include "UART.h"
+#include "VRR.h"
+#include "packet.h"
+
+// Times each case is run, keeping the fastest
+#define BENCH_RUNS 5
+// Samples in the input buffers - more than any window, so the windows move through memory
+#define BENCH_NB_SAMPLES 4096
+// Most bytes fed to Packet_Get in one op
+#define BENCH_MAX_BYTES (64 * (PACKET_FRAME_HEADER_SIZE + PACKET_FRAME_COMMAND_PAYLOAD + PACKET_FRAME_TRAILER_SIZE))
+
+#define VOLT_PER_BIT 3276.7
+
+// Samples per alarm timing period in the pipeline case - 10 ms at the firmware's 1.25 ms sample period
+#define BENCH_SAMPLES_PER_TIMING 8
+#define BENCH_TIMING_PERIOD 10000000
+
+/*! @brief Input distributions.
+ *
+ */
+typedef enum
+{
+  DIST_SINE,        /*!< 2.5 V RMS, 16 samples per cycle */
+  DIST_NOISE,       /*!< Uniform over the whole ADC range */
+  DIST_DC,          /*!< 2.5 V, the nominal voltage */
+  DIST_RANGE,       /*!< Uniform between 1.5 V and 3.5 V, either side of the limits */
+  DIST_LEGACY,      /*!< Valid 5 byte packets */
+  DIST_EXTENDED,    /*!< Valid CRC frames */
+  DIST_GARBAGE      /*!< Random bytes */
+} TDistribution;
+
+static const char* const DistributionNames[] =
+{
+  [DIST_SINE] = "sine",
+  [DIST_NOISE] = "noise",
+  [DIST_DC] = "dc",
+  [DIST_RANGE] = "range",
+  [DIST_LEGACY] = "legacy",
+  [DIST_EXTENDED] = "extended",
+  [DIST_GARBAGE] = "garbage"
+};
+
+/*!
+ * @struct TCase
+ */
+typedef struct TCase
+{
+  const char* name;                 /*!< Kernel */
+  const char* unit;                 /*!< What size counts */
+  uint32_t size;                    /*!< Items per op */
+  TDistribution distribution;       /*!< Input */
+  void (*setup)(const struct TCase* const bench);           /*!< Prepares the input */
+  void (*run)(const struct TCase* const bench, uint32_t nbOps);  /*!< Does nbOps ops */
+} TCase;
+
+// Results the compiler cannot see are unused
+static volatile int32_t Sink;
+
+static int16_t Samples[BENCH_NB_SAMPLES];
+
+// Stand-in UART - Packet_Get reads from In, Packet_Put writes to Out
+static uint8_t In[BENCH_MAX_BYTES];
+static uint16_t InLength;
+static uint16_t InPosition;
+static uint8_t Out[PACKET_FRAME_MAX_SIZE];
+
+static FIFO_t Fifo;
+
+static TRegulator Regulator;
+
+static TFrequencyEstimator FrequencyEstimator;
+
+/*! @brief xorshift32, so every run gets the same input.
+ *
+ */
+static uint32_t Random(void)
+{
+  static uint32_t state = 2463534242u;
+
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+static void SetupSamples(const TCase* const bench)
+{
+  for (uint32_t sampleNb = 0; sampleNb < BENCH_NB_SAMPLES; sampleNb++)
+  {
+    switch (bench->distribution)
+    {
+      case DIST_SINE:
+        Samples[sampleNb] = (int16_t)lround(2.5 * VOLT_PER_BIT * M_SQRT2 * sin(2 * M_PI * sampleNb / 16));
+        break;
+      case DIST_NOISE:
+        Samples[sampleNb] = (int16_t)Random();
+        break;
+      case DIST_DC:
+        Samples[sampleNb] = (int16_t)lround(2.5 * VOLT_PER_BIT);
+        break;
+      case DIST_RANGE:
+        Samples[sampleNb] = (int16_t)lround((1.5 + 2.0 * (Random() % 10000) / 10000) * VOLT_PER_BIT);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+static void RunRMS(const TCase* const bench, uint32_t nbOps)
+{
+  uint32_t offset = 0;
+
+  while (nbOps--)
+  {
+    int16_t rms[RMS_NB_CHANNELS];
+
+    // The samples taken as a window of every channel, interleaved as the acquisition stores them
+    RMS_CalculateAll((const int16_t (*)[RMS_NB_CHANNELS])&Samples[offset], (int16_t)bench->size, rms);
+    Sink = rms[0] + rms[1] + rms[2];
+
+    offset += bench->size * RMS_NB_CHANNELS;
+    if (offset + bench->size * RMS_NB_CHANNELS > BENCH_NB_SAMPLES)
+      offset = 0;
+  }
+}
+
+static void RunDeviation(const TCase* const bench, uint32_t nbOps)
+{
+  while (nbOps--)
+  {
+    int32_t sum = 0;
+
+    for (uint32_t sampleNb = 0; sampleNb < bench->size; sampleNb++)
+      sum += VRR_CalcDeviation(Samples[sampleNb]);
+    Sink = sum;
+  }
+}
+
+static void RunZeroCrossing(const TCase* const bench, uint32_t nbOps)
+{
+  while (nbOps--)
+  {
+    int32_t count = 0;
+
+    for (uint32_t sampleNb = 1; sampleNb <= bench->size; sampleNb++)
+      count += Frequency_isZeroCrossing(Samples[sampleNb - 1], Samples[sampleNb]);
+    Sink = count;
+  }
+}
+
+static void SetupFrequency(const TCase* const bench)
+{
+  SetupSamples(bench);
+  // The firmware's 800 Hz sample rate, averaged over 4 cycles
+  (void)Frequency_Init(&FrequencyEstimator, 800, 4);
+}
+
+static void RunFrequency(const TCase* const bench, uint32_t nbOps)
+{
+  uint32_t offset = 0;
+
+  while (nbOps--)
+  {
+    for (uint32_t sampleNb = 0; sampleNb < bench->size; sampleNb++)
+      Frequency_Update(&FrequencyEstimator, Samples[(offset + sampleNb) & (BENCH_NB_SAMPLES - 1)]);
+    Sink = Frequency_Get(&FrequencyEstimator);
+    offset = (offset + bench->size) & (BENCH_NB_SAMPLES - 1);
+  }
+}
+
+static void SetupRegulator(const TCase* const bench)
+{
+  SetupSamples(bench);
+  (void)Regulator_Init(&Regulator, BENCH_TIMING_PERIOD);
+}
+
+/*! @brief Runs the pipeline the way the firmware's threads do, one sample tick at a time.
+ *
+ */
+static void RunRegulator(const TCase* const bench, uint32_t nbOps)
+{
+  uint32_t offset = 0;
+
+  while (nbOps--)
+  {
+    int16_t outputs[REGULATOR_NB_OUTPUTS];
+
+    for (uint32_t sampleNb = 0; sampleNb < bench->size; sampleNb++)
+    {
+      int16_t samples[REGULATOR_NB_CHANNELS];
+
+      // Each channel a third of a cycle behind the one before
+      for (uint8_t channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+        samples[channelNb] = Samples[(offset + sampleNb + channelNb * 5) & (BENCH_NB_SAMPLES - 1)];
+
+      // Inverse timing, so the alarm timers use each channel's deviation
+      if (Regulator_Sample(&Regulator, samples))
+        Regulator_Window(&Regulator, INVERSE);
+
+      if ((sampleNb % BENCH_SAMPLES_PER_TIMING) == 0)
+      {
+        for (uint8_t channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+          (void)Regulator_Timing(&Regulator, channelNb);
+      }
+
+      Regulator_Outputs(&Regulator, outputs);
+    }
+
+    Sink = outputs[REGULATOR_OUTPUT_ALARM];
+    offset = (offset + bench->size) & (BENCH_NB_SAMPLES - 1);
+  }
+}
+
+static void SetupPackets(const TCase* const bench)
+{
+  InLength = 0;
+
+  for (uint32_t packetNb = 0; packetNb < bench->size; packetNb++)
+  {
+    uint8_t command = 0x04 + (packetNb % 8), p1 = Random(), p2 = Random(), p3 = Random();
+
+    switch (bench->distribution)
+    {
+      case DIST_LEGACY:
+        In[InLength++] = command;
+        In[InLength++] = p1;
+        In[InLength++] = p2;
+        In[InLength++] = p3;
+        In[InLength++] = command ^ p1 ^ p2 ^ p3;
+        break;
+      case DIST_EXTENDED:
+        In[InLength + PACKET_FRAME_HEADER_SIZE] = p1;
+        In[InLength + PACKET_FRAME_HEADER_SIZE + 1] = p2;
+        In[InLength + PACKET_FRAME_HEADER_SIZE + 2] = p3;
+        InLength += Packet_FrameSeal(&In[InLength], command, PACKET_FRAME_COMMAND_PAYLOAD);
+        break;
+      default:
+        for (uint8_t byteNb = 0; byteNb < PACKET_NB_BYTES; byteNb++)
+          In[InLength++] = Random();
+        break;
+    }
+  }
+
+  (void)Packet_SetProtocol((bench->distribution == DIST_EXTENDED) ? PACKET_PROTOCOL_EXTENDED : PACKET_PROTOCOL_LEGACY);
+}
+
+static void RunPacketGet(const TCase* const bench, uint32_t nbOps)
+{
+  TPacket packet;
+
+  while (nbOps--)
+  {
+    int32_t count = 0;
+
+    InPosition = 0;
+    while (Packet_Get(&packet))
+      count++;
+    Sink = count;
+  }
+}
+
+static void SetupProtocol(const TCase* const bench)
+{
+  (void)Packet_SetProtocol((bench->distribution == DIST_EXTENDED) ? PACKET_PROTOCOL_EXTENDED : PACKET_PROTOCOL_LEGACY);
+}
+
+static void RunPacketPut(const TCase* const bench, uint32_t nbOps)
+{
+  uint8_t parameter = 0;
+
+  while (nbOps--)
+  {
+    for (uint32_t packetNb = 0; packetNb < bench->size; packetNb++)
+      (void)Packet_Put(0x04, parameter++, 0x12, 0x34);
+  }
+}
+
+static void SetupFifo(const TCase* const bench)
+{
+  static bool initialised;
+
+  // Each FIFO_Init takes two more semaphores
+  if (!initialised)
+    FIFO_Init(&Fifo);
+  initialised = true;
+}
+
+static void RunFifo(const TCase* const bench, uint32_t nbOps)
+{
+  uint8_t data;
+
+  while (nbOps--)
+  {
+    for (uint32_t byteNb = 0; byteNb < bench->size; byteNb++)
+      FIFO_Put(&Fifo, (uint8_t)byteNb);
+    for (uint32_t byteNb = 0; byteNb < bench->size; byteNb++)
+      FIFO_Get(&Fifo, &data);
+    Sink = data;
+  }
+}
+
+static const TCase Cases[] =
+{
+  {"rms", "samples", 4, DIST_SINE, SetupSamples, RunRMS},
+  {"rms", "samples", 8, DIST_SINE, SetupSamples, RunRMS},
+  {"rms", "samples", 16, DIST_SINE, SetupSamples, RunRMS},
+  {"rms", "samples", 16, DIST_NOISE, SetupSamples, RunRMS},
+  {"rms", "samples", 16, DIST_DC, SetupSamples, RunRMS},
+  {"vrr_deviation", "samples", 256, DIST_DC, SetupSamples, RunDeviation},
+  {"vrr_deviation", "samples", 256, DIST_RANGE, SetupSamples, RunDeviation},
+  {"vrr_deviation", "samples", 256, DIST_NOISE, SetupSamples, RunDeviation},
+  {"zero_crossing", "samples", 16, DIST_SINE, SetupSamples, RunZeroCrossing},
+  {"zero_crossing", "samples", 1024, DIST_SINE, SetupSamples, RunZeroCrossing},
+  {"zero_crossing", "samples", 1024, DIST_NOISE, SetupSamples, RunZeroCrossing},
+  {"zero_crossing", "samples", 1024, DIST_DC, SetupSamples, RunZeroCrossing},
+  {"frequency_update", "samples", 1024, DIST_SINE, SetupFrequency, RunFrequency},
+  {"frequency_update", "samples", 1024, DIST_NOISE, SetupFrequency, RunFrequency},
+  {"regulator", "samples", 1024, DIST_SINE, SetupRegulator, RunRegulator},
+  {"regulator", "samples", 1024, DIST_RANGE, SetupRegulator, RunRegulator},
+  {"packet_get", "packets", 1, DIST_LEGACY, SetupPackets, RunPacketGet},
+  {"packet_get", "packets", 64, DIST_LEGACY, SetupPackets, RunPacketGet},
+  {"packet_get", "packets", 64, DIST_EXTENDED, SetupPackets, RunPacketGet},
+  {"packet_get", "packets", 64, DIST_GARBAGE, SetupPackets, RunPacketGet},
+  {"packet_put", "packets", 64, DIST_LEGACY, SetupProtocol, RunPacketPut},
+  {"packet_put", "packets", 64, DIST_EXTENDED, SetupProtocol, RunPacketPut},
+  {"fifo", "bytes", 1, DIST_DC, SetupFifo, RunFifo},
+  {"fifo", "bytes", 32, DIST_DC, SetupFifo, RunFifo},
+  {"fifo", "bytes", 128, DIST_DC, SetupFifo, RunFifo}
+};
+
+/*! @brief Gets the time in ns.
+ *
+ */
+static double Now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/*! @brief Times a case.
+ *
+ *  @return double - The fastest time of an op in ns.
+ */
+static double Measure(const TCase* const bench, const double minTime)
+{
+  uint32_t nbOps = 1;
+  double best = INFINITY;
+
+  bench->setup(bench);
+
+  // Find how many ops take long enough to time, which also warms the caches and branch predictors
+  for (;;)
+  {
+    double start = Now();
+
+    bench->run(bench, nbOps);
+    if ((Now() - start >= minTime * 1e9 / 10) || (nbOps >= (1u << 30)))
+      break;
+    nbOps *= 2;
+  }
+  nbOps *= 10;
+
+  for (int runNb = 0; runNb < BENCH_RUNS; runNb++)
+  {
+    double start = Now();
+    double time;
+
+    bench->run(bench, nbOps);
+    time = (Now() - start) / nbOps;
+    if (time < best)
+      best = time;
+  }
+
+  return best;
+}
+
+int main(int argc, char* argv[])
+{
+  double minTime = 0.2;
+  const char* filter = "";
+  FILE* results = stdout;
+  bool first = true;
+  int option;
+
+  while ((option = getopt(argc, argv, "t:o:")) != -1)
+  {
+    switch (option)
+    {
+      case 't':
+        minTime = atof(optarg);
+        break;
+      case 'o':
+        results = fopen(optarg, "w");
+        if (!results)
+        {
+          perror(optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-t seconds] [-o results.json] [name]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+
+  if (optind < argc)
+    filter = argv[optind];
+
+  if (!Packet_Init(115200, CPU_BUS_CLK_HZ))
+    return EXIT_FAILURE;
+
+  fprintf(results, "{\"suite\": \"host\", \"version\": 1, \"compiler\": \"%s\", \"results\": [", __VERSION__);
+  fprintf(stderr, "%-14s %6s %-9s %12s %14s\n", "kernel", "size", "input", "ns/op", "items/s");
+
+  for (size_t caseNb = 0; caseNb < sizeof(Cases) / sizeof(Cases[0]); caseNb++)
+  {
+    const TCase* bench = &Cases[caseNb];
+    double time;
+
+    if (strncmp(bench->name, filter, strlen(filter)) != 0)
+      continue;
+
+    time = Measure(bench, minTime);
+
+    fprintf(stderr, "%-14s %6u %-9s %12.2f %14.4g %s\n", bench->name, bench->size, DistributionNames[bench->distribution],
+            time, bench->size * 1e9 / time, bench->unit);
+    fprintf(results, "%s\n  {\"name\": \"%s\", \"size\": %u, \"distribution\": \"%s\", \"unit\": \"%s\", "
+            "\"ns_per_op\": %.3f, \"ops_per_s\": %.6g, \"items_per_s\": %.6g}", first ? "" : ",",
+            bench->name, bench->size, DistributionNames[bench->distribution], bench->unit, time, 1e9 / time,
+            bench->size * 1e9 / time);
+    first = false;
+  }
+
+  fprintf(results, "\n]}\n");
+
+  return (fclose(results) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Stand-ins for the UART driver and libOS */
+
+bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  return true;
+}
+
+bool UART_InChar(uint8_t* const dataPtr)
+{
+  if (InPosition == InLength)
+    return false;
+
+  *dataPtr = In[InPosition++];
+  return true;
+}
+
+bool UART_OutFrame(const uint8_t* const data, const uint8_t length)
+{
+  // Copied as the driver copies it into its queue
+  memcpy(Out, data, length);
+  return true;
+}
+
+bool UART_OutBuffer(const uint8_t* const data, const uint16_t length, volatile bool* const busy)
+{
+  *busy = false;
+  return true;
+}
+
+OS_ECB* OS_SemaphoreCreate(const uint32_t value)
+{
+  static OS_ECB semaphores[16];
+  static uint8_t nbSemaphores;
+
+  if (nbSemaphores == sizeof(semaphores) / sizeof(semaphores[0]))
+    return NULL;
+
+  semaphores[nbSemaphores].count = value;
+  return &semaphores[nbSemaphores++];
+}
+
+OS_ERROR OS_SemaphoreSignal(OS_ECB* const pEvent)
+{
+  pEvent->count++;
+  return OS_NO_ERROR;
+}
+
+OS_ERROR OS_SemaphoreWait(OS_ECB* const pEvent, const uint32_t timeout)
+{
+  // Nothing else runs, so waiting would never end
+  if (pEvent->count == 0)
+    return OS_TIMEOUT;
+
+  pEvent->count--;
+  return OS_NO_ERROR;
+}
+
+void OS_HostDisableInterrupts(void)
+{
+}
+
+void OS_HostEnableInterrupts(void)
+{
+}
+
+/*!
+** @}
+*/
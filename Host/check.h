@@ -0,0 +1,61 @@
+/*! @file
+ *
+ *  @brief Assertions for the host tests.
+ *
+ *  Each test is a program of its own built by "make check". A failed check prints where it is and the
+ *  test carries on, so one run shows every failure; the program's exit status is the number of failures.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+static unsigned CheckFailures;
+
+/*! @brief Records the result of a check.
+ *
+ *  @return int - passed, so a test can skip checks that depend on this one.
+ */
+static inline int CheckResult(const int passed, const char* const text, const char* const file, const int line)
+{
+  if (!passed)
+  {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+    CheckFailures++;
+  }
+
+  return passed;
+}
+
+/*! @brief Records the result of comparing two integers, printing both if they differ.
+ *
+ */
+static inline int CheckEqual(const long long actual, const long long expected, const char* const text,
+                             const char* const file, const int line)
+{
+  if (actual != expected)
+  {
+    fprintf(stderr, "%s:%d: check failed: %s is %lld, expected %lld\n", file, line, text, actual, expected);
+    CheckFailures++;
+  }
+
+  return actual == expected;
+}
+
+#define CHECK(condition) CheckResult((condition) != 0, #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(actual, expected) CheckEqual((long long)(actual), (long long)(expected), #actual, __FILE__, __LINE__)
+
+/*! @brief Prints the summary line and gives the exit status.
+ *
+ */
+static inline int CheckDone(const char* const name)
+{
+  fprintf(stderr, "%s: %s\n", name, CheckFailures ? "FAILED" : "passed");
+  return (CheckFailures > 255) ? 255 : (int)CheckFailures;
+}
+
+#endif
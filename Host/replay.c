@@ -0,0 +1,225 @@
+/*! @file
+ *
+ *  @brief Replays a capture file through the regulation pipeline.
+ *
+ *  Feeds every sample of a capture (see Capture.h) to the frequency estimator and the Regulator stages
+ *  in the order the firmware threads run them, as fast as the host allows. The trace is the same as
+ *  build/sim's, so a capture of a field event can be checked against a simulation of it or against an
+ *  earlier build, and the summary gives the throughput for profiling.
+ *
+ *    build/replay [-m inverse] [-q] [-r passes] capture
+ *
+ *  -m picks the timing characteristic, definite by default, -q leaves out the trace and -r runs the
+ *  capture that many times, each on a fresh pipeline, to get a steadier timing.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup replay_module replay module documentation
+**  @{
+*/
+/* MODULE replay */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CaptureFile.h"
+#include "Frequency.h"
+#include "Regulator.h"
+
+// Same scaling, frequency estimate and timing PIT channel as the firmware
+#define VOLT_PER_BIT 3276.7f
+#define FREQUENCY_CHANNEL 0
+#define FREQUENCY_NB_CYCLES 4
+#define TIMING_PERIOD 10000000
+
+static const char* const OutputNames[REGULATOR_NB_OUTPUTS] =
+{
+  [REGULATOR_OUTPUT_RAISE] = "raise",
+  [REGULATOR_OUTPUT_LOWER] = "lower",
+  [REGULATOR_OUTPUT_ALARM] = "alarm"
+};
+
+static TimerType Mode = DEFINITE;
+static bool Quiet;
+
+/*!
+ * @struct TResult
+ */
+typedef struct
+{
+  uint64_t nbSamples;       /*!< Samples per channel replayed */
+  uint32_t nbRaises;        /*!< Raises at the end */
+  uint32_t nbLowers;        /*!< Lowers at the end */
+  uint16_t frequency;       /*!< Last frequency estimate in 0.01 Hz */
+} TResult;
+
+/*! @brief Replays the capture once.
+ *
+ *  @param reader The capture, positioned at its first chunk.
+ *  @param trace TRUE to print the output changes.
+ *  @param result The totals.
+ *  @return bool - TRUE if every chunk was read.
+ */
+static bool Replay(TCaptureReader* const reader, const bool trace, TResult* const result)
+{
+  static int16_t channels[CAPTURE_MAX_CHANNELS][UINT16_MAX];
+  int16_t* samples[CAPTURE_MAX_CHANNELS];
+  TRegulator regulator;
+  TFrequencyEstimator estimator;
+  int16_t outputs[REGULATOR_NB_OUTPUTS], lastOutputs[REGULATOR_NB_OUTPUTS] = {0};
+  uint8_t nbChannels = reader->info.nbChannels;
+  float scale = VOLT_PER_BIT / reader->info.voltPerBit;
+  bool rescale = fabsf(scale - 1.0f) > 0.001f;
+  uint16_t nbSamples;
+  uint64_t nextTiming = TIMING_PERIOD;
+
+  for (uint8_t channelNb = 0; channelNb < CAPTURE_MAX_CHANNELS; channelNb++)
+    samples[channelNb] = channels[channelNb];
+
+  if (!Regulator_Init(&regulator, TIMING_PERIOD)
+      || !Frequency_Init(&estimator, 1000000000 / reader->info.samplePeriod, FREQUENCY_NB_CYCLES))
+    return false;
+
+  memset(result, 0, sizeof(*result));
+
+  while (reader->offset < reader->length)
+  {
+    if (!Capture_ReadChunk(reader, samples, UINT16_MAX, &nbSamples))
+    {
+      fprintf(stderr, "damaged chunk at offset %u\n", (unsigned)reader->offset);
+      return false;
+    }
+
+    for (uint16_t sampleNb = 0; sampleNb < nbSamples; sampleNb++)
+    {
+      int16_t sample[REGULATOR_NB_CHANNELS] = {0};
+
+      // Channels the capture does not have stay at 0
+      for (uint8_t channelNb = 0; (channelNb < nbChannels) && (channelNb < REGULATOR_NB_CHANNELS); channelNb++)
+        sample[channelNb] = rescale ? (int16_t)lrintf(channels[channelNb][sampleNb] * scale) : channels[channelNb][sampleNb];
+
+      // Sample_Thread, then RMS_CalcThread when a window is done - as in build/sim, the window ends on
+      // the last sample of a block, so taking the samples one at a time works it out at the same time
+      Frequency_Update(&estimator, sample[FREQUENCY_CHANNEL]);
+      if (Regulator_Sample(&regulator, sample))
+        Regulator_Window(&regulator, Mode);
+      result->nbSamples++;
+
+      // Then the Alarm_Threads, for every expiry of the timing PIT channel up to this sample
+      while (nextTiming <= result->nbSamples * reader->info.samplePeriod)
+      {
+        for (uint8_t channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+          (void)Regulator_Timing(&regulator, channelNb);
+        nextTiming += TIMING_PERIOD;
+      }
+
+      // SignalOutput_Thread
+      Regulator_Outputs(&regulator, outputs);
+
+      for (int outputNb = 0; outputNb < REGULATOR_NB_OUTPUTS; outputNb++)
+      {
+        if (outputs[outputNb] != lastOutputs[outputNb])
+        {
+          if (trace)
+            printf("%.4f %s %d\n", (double)result->nbSamples * reader->info.samplePeriod / 1e9, OutputNames[outputNb], outputs[outputNb] != 0);
+          lastOutputs[outputNb] = outputs[outputNb];
+        }
+      }
+    }
+  }
+
+  result->nbRaises = regulator.nbRaises;
+  result->nbLowers = regulator.nbLowers;
+  result->frequency = Frequency_Get(&estimator);
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  TCaptureReader reader;
+  TResult result;
+  uint32_t firstChunk;
+  unsigned passes = 1;
+  struct timespec start, finish;
+  double elapsed, duration;
+  int option;
+
+  while ((option = getopt(argc, argv, "m:qr:")) != -1)
+  {
+    switch (option)
+    {
+      case 'm':
+        if (strcmp(optarg, "inverse") == 0)
+          Mode = INVERSE;
+        else if (strcmp(optarg, "definite") == 0)
+          Mode = DEFINITE;
+        else
+          goto usage;
+        break;
+
+      case 'q':
+        Quiet = true;
+        break;
+
+      case 'r':
+        passes = (unsigned)strtoul(optarg, NULL, 0);
+        if (passes == 0)
+          goto usage;
+        break;
+
+      default:
+        goto usage;
+    }
+  }
+
+  if (optind != argc - 1)
+    goto usage;
+
+  if (!CaptureFile_Map(argv[optind], &reader))
+    return EXIT_FAILURE;
+
+  firstChunk = reader.offset;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (unsigned pass = 0; pass < passes; pass++)
+  {
+    reader.offset = firstChunk;
+
+    // Only the first pass is traced, the rest are for the timing
+    if (!Replay(&reader, !Quiet && (pass == 0), &result))
+    {
+      CaptureFile_Unmap(&reader);
+      return EXIT_FAILURE;
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &finish);
+  elapsed = (finish.tv_sec - start.tv_sec) + (finish.tv_nsec - start.tv_nsec) / 1e9;
+  duration = (double)result.nbSamples * reader.info.samplePeriod / 1e9;
+
+  if ((reader.info.nbSamples != 0) && (reader.info.nbSamples != result.nbSamples))
+    fprintf(stderr, "header says %u samples, capture has %llu\n", (unsigned)reader.info.nbSamples, (unsigned long long)result.nbSamples);
+
+  fprintf(stderr, "%u x %.1f s replayed in %.3f s (%.0fx), %.1f Msamples/s, %u raises, %u lowers, %u.%02u Hz\n",
+          passes, duration, elapsed, passes * duration / elapsed, passes * result.nbSamples / elapsed / 1e6,
+          result.nbRaises, result.nbLowers, result.frequency / 100, result.frequency % 100);
+
+  CaptureFile_Unmap(&reader);
+  return EXIT_SUCCESS;
+
+usage:
+  fprintf(stderr, "usage: %s [-m inverse] [-q] [-r passes] capture\n", argv[0]);
+  return EXIT_FAILURE;
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,268 @@
+/*! @file
+ *
+ *  @brief Discrete event simulation of the regulation pipeline.
+ *
+ *  Runs the Regulator stages in the order the firmware threads run them, off a virtual PIT clock, so
+ *  days of regulator behaviour take seconds. The input is a voltage profile and the output is a trace
+ *  of the raise, lower and alarm outputs.
+ *
+ *  The profile is read from the file named on the command line, or from stdin:
+ *
+ *    # comment
+ *    mode inverse                  timing characteristic, definite (the default) or inverse
+ *    end 86400                     seconds to simulate, else 10 s after the last step
+ *    0     2.5                     from 0 s every channel is 2.5 V RMS
+ *    60    1.8  2.5  2.6           from 60 s channel 0 is 1.8 V, channel 1 2.5 V and channel 2 2.6 V
+ *
+ *  Each trace line is "seconds output level", e.g. "65.0100 raise 1".
+ *
+ *  With -c the generated samples are also written to a capture file, for build/replay or ANALOG_INPUT:
+ *
+ *    build/sim [-c capture] [profile]
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup sim_module sim module documentation
+**  @{
+*/
+/* MODULE sim */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CaptureFile.h"
+#include "Regulator.h"
+
+// Same sampling as the firmware - 16 samples per 50 Hz cycle
+#define SAMPLE_PERIOD 1250000
+#define CYCLE_SAMPLES 16
+// Same as the firmware's timing PIT channel - the alarm timers advance every 10 ms
+#define TIMING_PERIOD 10000000
+
+#define VOLT_PER_BIT 3276.7
+
+// Most steps in a profile
+#define MAX_STEPS 4096
+// Seconds simulated after the last step when the profile has no end
+#define DEFAULT_TAIL 10.0
+
+/*!
+ * @struct TStep
+ */
+typedef struct
+{
+  double time;                                  /*!< When the step happens, in s */
+  double rms[REGULATOR_NB_CHANNELS];            /*!< RMS voltage of each channel from then on */
+} TStep;
+
+static const char* const OutputNames[REGULATOR_NB_OUTPUTS] =
+{
+  [REGULATOR_OUTPUT_RAISE] = "raise",
+  [REGULATOR_OUTPUT_LOWER] = "lower",
+  [REGULATOR_OUTPUT_ALARM] = "alarm"
+};
+
+static TStep Steps[MAX_STEPS];
+static uint32_t NbSteps;
+static TimerType Mode = DEFINITE;
+static double End = -1;
+
+/*! @brief Reads the voltage profile.
+ *
+ *  @return bool - TRUE if the profile was valid.
+ */
+static bool ReadProfile(FILE* const file)
+{
+  char line[256];
+  uint32_t lineNb = 0;
+
+  while (fgets(line, sizeof(line), file))
+  {
+    char word[16];
+    TStep* step;
+    int nbValues;
+
+    lineNb++;
+    if ((sscanf(line, " %15s", word) != 1) || (word[0] == '#'))
+      continue;
+
+    if (strcmp(word, "mode") == 0)
+    {
+      if (sscanf(line, " mode %15s", word) != 1)
+        goto invalid;
+      if (strcmp(word, "inverse") == 0)
+        Mode = INVERSE;
+      else if (strcmp(word, "definite") == 0)
+        Mode = DEFINITE;
+      else
+        goto invalid;
+      continue;
+    }
+
+    if (strcmp(word, "end") == 0)
+    {
+      if (sscanf(line, " end %lf", &End) != 1)
+        goto invalid;
+      continue;
+    }
+
+    if (NbSteps == MAX_STEPS)
+    {
+      fprintf(stderr, "line %u: more than %u steps\n", lineNb, MAX_STEPS);
+      return false;
+    }
+
+    step = &Steps[NbSteps];
+    nbValues = sscanf(line, "%lf %lf %lf %lf", &step->time, &step->rms[0], &step->rms[1], &step->rms[2]);
+    if ((nbValues < 2) || ((NbSteps > 0) && (step->time < Steps[NbSteps - 1].time)))
+      goto invalid;
+
+    // Channels that are left out follow channel 0
+    for (int channelNb = nbValues - 1; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+      step->rms[channelNb] = step->rms[0];
+
+    NbSteps++;
+    continue;
+
+invalid:
+    fprintf(stderr, "line %u: cannot read \"%s\"\n", lineNb, strtok(line, "\n"));
+    return false;
+  }
+
+  return NbSteps > 0;
+}
+
+int main(int argc, char* argv[])
+{
+  FILE* profile = stdin;
+  TRegulator regulator;
+  double unit[CYCLE_SAMPLES];
+  int16_t levels[REGULATOR_NB_CHANNELS][CYCLE_SAMPLES];
+  int16_t outputs[REGULATOR_NB_OUTPUTS], lastOutputs[REGULATOR_NB_OUTPUTS] = {0};
+  uint64_t nbSamples, nextStep = 0, nextTiming = TIMING_PERIOD;
+  struct timespec start, finish;
+  double elapsed;
+  const char* capturePath = NULL;
+  TCaptureFile capture = {0};
+  int option;
+
+  while ((option = getopt(argc, argv, "c:")) != -1)
+  {
+    if (option != 'c')
+      goto usage;
+    capturePath = optarg;
+  }
+
+  if (optind < argc)
+  {
+    profile = fopen(argv[optind], "r");
+    if (!profile)
+    {
+      perror(argv[optind]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!ReadProfile(profile))
+    goto usage;
+
+  if (capturePath)
+  {
+    const TCaptureInfo info =
+    {
+      .nbChannels = REGULATOR_NB_CHANNELS,
+      .samplePeriod = SAMPLE_PERIOD,
+      .voltPerBit = VOLT_PER_BIT
+    };
+
+    if (!CaptureFile_Create(&capture, capturePath, &info, CAPTURE_ENCODING_DELTA))
+      return EXIT_FAILURE;
+  }
+
+  if (End < 0)
+    End = Steps[NbSteps - 1].time + DEFAULT_TAIL;
+  nbSamples = (uint64_t)(End * 1e9 / SAMPLE_PERIOD);
+
+  for (int sampleNb = 0; sampleNb < CYCLE_SAMPLES; sampleNb++)
+    unit[sampleNb] = M_SQRT2 * sin(2 * M_PI * sampleNb / CYCLE_SAMPLES);
+
+  Regulator_Init(&regulator, TIMING_PERIOD);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (uint64_t sample = 0; sample < nbSamples; sample++)
+  {
+    int16_t samples[REGULATOR_NB_CHANNELS];
+    uint8_t phase = sample % CYCLE_SAMPLES;
+
+    // Apply the steps that are due, working out a cycle of each channel's waveform
+    while ((nextStep < NbSteps) && ((uint64_t)(Steps[nextStep].time * 1e9 / SAMPLE_PERIOD) <= sample))
+    {
+      for (int channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+        for (int sampleNb = 0; sampleNb < CYCLE_SAMPLES; sampleNb++)
+          levels[channelNb][sampleNb] = (int16_t)lround(Steps[nextStep].rms[channelNb] * VOLT_PER_BIT * unit[sampleNb]);
+      nextStep++;
+    }
+
+    for (int channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+      samples[channelNb] = levels[channelNb][phase];
+
+    if (capture.file && !CaptureFile_Append(&capture, samples))
+    {
+      fprintf(stderr, "%s: write failed\n", capturePath);
+      return EXIT_FAILURE;
+    }
+
+    // Sample_Thread, then RMS_CalcThread when a window is done - the firmware takes the samples a block
+    // at a time, but a window always ends on the last sample of a block, so it is worked out at the same time
+    if (Regulator_Sample(&regulator, samples))
+      Regulator_Window(&regulator, Mode);
+
+    // Then the Alarm_Threads, for every expiry of the timing PIT channel up to this sample
+    while (nextTiming <= (sample + 1) * SAMPLE_PERIOD)
+    {
+      for (uint8_t channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+        (void)Regulator_Timing(&regulator, channelNb);
+      nextTiming += TIMING_PERIOD;
+    }
+
+    // SignalOutput_Thread
+    Regulator_Outputs(&regulator, outputs);
+    for (int outputNb = 0; outputNb < REGULATOR_NB_OUTPUTS; outputNb++)
+    {
+      if (outputs[outputNb] != lastOutputs[outputNb])
+      {
+        printf("%.4f %s %d\n", (double)(sample + 1) * SAMPLE_PERIOD / 1e9, OutputNames[outputNb], outputs[outputNb] != 0);
+        lastOutputs[outputNb] = outputs[outputNb];
+      }
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &finish);
+
+  if (capture.file && !CaptureFile_Close(&capture))
+  {
+    fprintf(stderr, "%s: write failed\n", capturePath);
+    return EXIT_FAILURE;
+  }
+  elapsed = (finish.tv_sec - start.tv_sec) + (finish.tv_nsec - start.tv_nsec) / 1e9;
+
+  fprintf(stderr, "%.0f s simulated in %.3f s (%.0fx), %llu samples, %u raises, %u lowers\n",
+          End, elapsed, End / elapsed, (unsigned long long)nbSamples, regulator.nbRaises, regulator.nbLowers);
+
+  return EXIT_SUCCESS;
+
+usage:
+  fprintf(stderr, "usage: %s [-c capture] [profile] - see sim.c for the profile format\n", argv[0]);
+  return EXIT_FAILURE;
+}
+
+/*!
+** @}
+*/
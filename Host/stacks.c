@@ -0,0 +1,205 @@
+/*! @file
+ *
+ *  @brief Turns the threads' stack high water marks into StackSizes.h.
+ *
+ *  Asks the tower for COMMAND_STACK of every thread over its serial port and writes a StackSizes.h with
+ *  each stack sized to what its thread has used plus headroom:
+ *
+ *    build/stacks /dev/ttyACM0 > ../Sources/StackSizes.h
+ *
+ *  Run it once the tower has been through everything it does - start up, every packet command,
+ *  streaming, alarms and tap changes - as a stack that was never needed cannot be measured. The threads
+ *  sharing a size, such as the three alarm threads, get the largest of their marks.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup stacks_module stacks module documentation
+**  @{
+*/
+/* MODULE stacks */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Monitor.h"
+#include "handle.h"
+
+// Headroom - a quarter on top, plus an interrupt's frame with the FPU state stacked on the thread's stack
+#define STACK_HEADROOM_DIVISOR 4
+#define STACK_FRAME_WORDS      32
+// Sizes are rounded up to keep the stacks 8 byte aligned with room to spare
+#define STACK_ROUNDING         8
+#define STACK_MIN_WORDS        64
+
+// How long to wait for the replies
+#define REPLY_TIMEOUT_MS 1000
+
+/*!
+ * @struct TThread
+ */
+typedef struct
+{
+  uint8_t priority;         /*!< As in main.c */
+  const char* size;         /*!< Its macro in StackSizes.h */
+} TThread;
+
+// Must match the priorities in main.c
+static const TThread Threads[] =
+{
+  {0, "INIT_MODULES_STACK_SIZE"},
+  {2, "SAMPLE_STACK_SIZE"},
+  {3, "RMS_STACK_SIZE"},
+  {4, "ALARM_STACK_SIZE"},
+  {5, "ALARM_STACK_SIZE"},
+  {6, "ALARM_STACK_SIZE"},
+  {8, "SIGNAL_OUTPUT_STACK_SIZE"},
+  {9, "HANDLE_PACKET_STACK_SIZE"},
+  {10, "HOUSEKEEPING_STACK_SIZE"}
+};
+
+#define NB_THREADS (sizeof(Threads) / sizeof(Threads[0]))
+
+static int32_t Used[256];
+
+/*! @brief Reads COMMAND_STACK replies until none have come for a while.
+ *
+ *  @return unsigned - The number of replies.
+ */
+static unsigned ReadReplies(const int port)
+{
+  struct pollfd poller = {.fd = port, .events = POLLIN};
+  uint8_t packet[PACKET_NB_BYTES];
+  unsigned length = 0, nbReplies = 0;
+
+  while (poll(&poller, 1, REPLY_TIMEOUT_MS) > 0)
+  {
+    if (read(port, &packet[length], 1) != 1)
+      break;
+
+    if (++length < PACKET_NB_BYTES)
+      continue;
+
+    // Slide along until the checksum lines up, as the firmware's parser does
+    if ((packet[0] == COMMAND_STACK) && ((packet[0] ^ packet[1] ^ packet[2] ^ packet[3]) == packet[4]))
+    {
+      Used[packet[1]] = packet[2] | (packet[3] << 8);
+      nbReplies++;
+      length = 0;
+    }
+    else
+    {
+      for (unsigned byteNb = 1; byteNb < PACKET_NB_BYTES; byteNb++)
+        packet[byteNb - 1] = packet[byteNb];
+      length--;
+    }
+  }
+
+  return nbReplies;
+}
+
+int main(int argc, char* argv[])
+{
+  const uint8_t request[PACKET_NB_BYTES] = {COMMAND_STACK, MONITOR_ALL_THREADS, 0, 0, COMMAND_STACK ^ MONITOR_ALL_THREADS};
+  struct termios settings;
+  uint32_t total = 0;
+  int port;
+
+  if (argc != 2)
+  {
+    fprintf(stderr, "usage: %s port > StackSizes.h\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  port = open(argv[1], O_RDWR | O_NOCTTY);
+  if (port < 0)
+  {
+    perror(argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  if (tcgetattr(port, &settings) == 0)
+  {
+    cfmakeraw(&settings);
+    cfsetspeed(&settings, B115200);
+    (void)tcsetattr(port, TCSANOW, &settings);
+  }
+  (void)tcflush(port, TCIFLUSH);
+
+  for (unsigned priority = 0; priority < 256; priority++)
+    Used[priority] = -1;
+
+  if ((write(port, request, sizeof(request)) != sizeof(request)) || (ReadReplies(port) == 0))
+  {
+    fprintf(stderr, "%s: no COMMAND_STACK replies\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  printf("/*! @file\n"
+         " *\n"
+         " *  @brief Thread stack sizes.\n"
+         " *\n"
+         " *  Sizes in words. Regenerate with Host/build/stacks from the high water marks of a tower that has run\n"
+         " *  every feature for a while.\n"
+         " *\n"
+         " *  @author 12604120, 12931717\n"
+         " *  @date 2026-10-19\n"
+         " */\n"
+         "\n"
+         "#ifndef STACK_SIZES_H\n"
+         "#define STACK_SIZES_H\n"
+         "\n"
+         "// Most words used plus headroom\n");
+
+  for (unsigned threadNb = 0; threadNb < NB_THREADS; threadNb++)
+  {
+    int32_t most = -1;
+    uint32_t size;
+    bool done = false;
+
+    // Each macro once, from the largest mark of the threads sharing it
+    for (unsigned otherNb = 0; otherNb < threadNb; otherNb++)
+      done |= (Threads[otherNb].size == Threads[threadNb].size);
+    if (done)
+      continue;
+
+    for (unsigned otherNb = threadNb; otherNb < NB_THREADS; otherNb++)
+    {
+      if ((Threads[otherNb].size == Threads[threadNb].size) && (Used[Threads[otherNb].priority] > most))
+        most = Used[Threads[otherNb].priority];
+    }
+
+    if (most < 0)
+    {
+      fprintf(stderr, "no reply for %s\n", Threads[threadNb].size);
+      return EXIT_FAILURE;
+    }
+
+    size = most + most / STACK_HEADROOM_DIVISOR + STACK_FRAME_WORDS;
+    size = (size + STACK_ROUNDING - 1) / STACK_ROUNDING * STACK_ROUNDING;
+    if (size < STACK_MIN_WORDS)
+      size = STACK_MIN_WORDS;
+
+    printf("#define %-24s %4u // %d used\n", Threads[threadNb].size, size, most);
+    fprintf(stderr, "%-24s %5d words used, %5u words\n", Threads[threadNb].size, most, size);
+
+    for (unsigned otherNb = threadNb; otherNb < NB_THREADS; otherNb++)
+      total += (Threads[otherNb].size == Threads[threadNb].size) ? size : 0;
+  }
+
+  printf("\n#endif\n");
+  fprintf(stderr, "%u words (%u bytes) of stack in all\n", total, total * 4);
+
+  close(port);
+  return EXIT_SUCCESS;
+}
+
+/*!
+** @}
+*/
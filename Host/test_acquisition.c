@@ -0,0 +1,239 @@
+/*! @file
+ *
+ *  @brief Host test of the hand-off of full blocks from the acquisition DMA to Acquisition_GetBlock.
+ *
+ *  Drives the AcquisitionDMA stand-in one trigger at a time, with every input reading a number that
+ *  gives away which sample it came from, and checks the samples, timestamp, in-time flag and dropped
+ *  count of each block handed over - with the consumer keeping up, one block behind and two blocks
+ *  behind. The PIT driver, libAnalog and libOS are replaced by the stand-ins at the end of this file;
+ *  a wait on an empty semaphore runs the DMA until the next block is full, as it would on the tower.
+ *
+ *    build/test_acquisition
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup test_acquisition_module test_acquisition module documentation
+**  @{
+*/
+/* MODULE test_acquisition */
+
+#include "check.h"
+#include "Acquisition.h"
+#include "AcquisitionDMA.h"
+#include "analog.h"
+#include "Cpu.h"
+#include "OS.h"
+#include "PIT.h"
+
+// Most blocks a test takes
+#define MAX_BLOCKS 64
+
+// The DMA stand-in's trigger, from PIT_ChannelInit
+static void (*Trigger)(void*);
+
+// Samples taken so far - each input reads its sample number times the number of inputs plus its own
+static uint32_t NbSamples;
+static uint8_t NextChannel;
+
+// Timestamps read just before and just after the first sample of each block
+static uint32_t Before[MAX_BLOCKS];
+static uint32_t After[MAX_BLOCKS];
+
+// Blocks handed over by the callback, and the stand-in semaphore
+static uint32_t NbCallbacks;
+static OS_ECB Semaphore;
+
+/*! @brief What an input reads in a sample.
+ *
+ */
+static int16_t Value(const uint32_t sampleNb, const uint8_t channelNb)
+{
+  return (int16_t)(sampleNb * ACQUISITION_NB_CHANNELS + channelNb);
+}
+
+/*! @brief Runs the DMA until another block is full.
+ *
+ */
+static void FillBlock(void)
+{
+  for (uint8_t sampleNb = 0; sampleNb < ACQUISITION_BLOCK_SAMPLES; sampleNb++)
+  {
+    uint32_t blockNb = NbSamples / ACQUISITION_BLOCK_SAMPLES;
+
+    if ((sampleNb == 0) && (blockNb < MAX_BLOCKS))
+    {
+      Before[blockNb] = Acquisition_Time();
+      Trigger(NULL);
+      After[blockNb] = Acquisition_Time();
+    }
+    else
+    {
+      Trigger(NULL);
+    }
+  }
+}
+
+static void Callback(void* arguments)
+{
+  NbCallbacks++;
+}
+
+/*! @brief Takes the next block and checks it is the one expected.
+ *
+ *  @param blockNb The number of the block that should be handed over, from 0.
+ *  @param dropped The blocks that should have been dropped before it.
+ */
+static void CheckBlock(const uint32_t blockNb, const uint32_t dropped)
+{
+  TAcquisitionBlock block;
+  uint32_t firstSample = blockNb * ACQUISITION_BLOCK_SAMPLES;
+  bool inTime = Acquisition_GetBlock(&block);
+
+  CHECK_EQUAL(inTime, dropped == 0);
+  CHECK_EQUAL(block.dropped, dropped);
+
+  // Taken between the reads either side of the first sample
+  CHECK(block.timestamp - Before[blockNb] <= After[blockNb] - Before[blockNb]);
+
+  for (uint8_t sampleNb = 0; sampleNb < ACQUISITION_BLOCK_SAMPLES; sampleNb++)
+  {
+    const TAcquisitionSample* const sample = &block.samples[sampleNb];
+
+    for (uint8_t channelNb = 0; channelNb < ACQUISITION_NB_CHANNELS; channelNb++)
+    {
+      if (!CHECK_EQUAL(sample->values[channelNb], Value(firstSample + sampleNb, channelNb)))
+        return;
+    }
+
+    // The first frame reads out the last input of the sample before
+    if (firstSample + sampleNb > 0)
+      CHECK_EQUAL(sample->unused, Value(firstSample + sampleNb - 1, ACQUISITION_NB_CHANNELS - 1));
+  }
+}
+
+/*! @brief A consumer that takes each block as it fills, the two blocks alternating.
+ *
+ */
+static void TestAlternating(uint32_t* const blockNb)
+{
+  const TAcquisitionSample* samples[2];
+  TAcquisitionBlock block;
+
+  for (uint8_t blocks = 0; blocks < 8; blocks++)
+    CheckBlock((*blockNb)++, 0);
+
+  // The consumer waits here, so the DMA fills the next one
+  (void)Acquisition_GetBlock(&block);
+  samples[0] = block.samples;
+  (void)Acquisition_GetBlock(&block);
+  samples[1] = block.samples;
+  CHECK(samples[0] != samples[1]);
+  (void)Acquisition_GetBlock(&block);
+  CHECK(block.samples == samples[0]);
+  *blockNb += 3;
+
+  CHECK_EQUAL(NbCallbacks, *blockNb);
+}
+
+/*! @brief A consumer still busy when nbBehind more blocks fill after the one it has yet to take.
+ *
+ */
+static void TestBehind(uint32_t* const blockNb, const uint8_t nbBehind)
+{
+  // The block it has yet to take, then the ones that fill while it is busy
+  for (uint8_t blocks = 0; blocks <= nbBehind; blocks++)
+    FillBlock();
+
+  // Only the latest block is still intact
+  *blockNb += nbBehind;
+  CheckBlock((*blockNb)++, nbBehind);
+
+  // The semaphore counts left over from the dropped blocks do not hand the same block over again
+  CheckBlock((*blockNb)++, 0);
+  CheckBlock((*blockNb)++, 0);
+}
+
+int main(void)
+{
+  uint32_t blockNb = 0;
+
+  CHECK(Acquisition_Init(CPU_BUS_CLK_HZ, Callback, NULL));
+  CHECK(Trigger != NULL);
+  Acquisition_Start(1250000);
+
+  TestAlternating(&blockNb);
+  TestBehind(&blockNb, 1);
+  TestBehind(&blockNb, 2);
+  TestAlternating(&blockNb);
+  CHECK(blockNb <= MAX_BLOCKS);
+
+  return CheckDone("test_acquisition");
+}
+
+/* Stand-ins for the PIT driver, libAnalog and libOS */
+
+bool PIT_ChannelInit(const uint8_t channelNb, void (*userFunction)(void*), void* userArguments)
+{
+  if (channelNb != ACQUISITION_PIT_CHANNEL)
+    return false;
+
+  Trigger = userFunction;
+  return true;
+}
+
+void PIT_Set(const uint8_t channelNb, const uint32_t period, const bool restart)
+{
+}
+
+bool Analog_Get(const uint8_t channelNb, int16_t* const valuePtr)
+{
+  CHECK_EQUAL(channelNb, NextChannel);
+
+  *valuePtr = Value(NbSamples, channelNb);
+  if (++NextChannel == ACQUISITION_NB_CHANNELS)
+  {
+    NextChannel = 0;
+    NbSamples++;
+  }
+
+  return true;
+}
+
+OS_ECB* OS_SemaphoreCreate(const uint32_t value)
+{
+  Semaphore.count = value;
+  return &Semaphore;
+}
+
+OS_ERROR OS_SemaphoreSignal(OS_ECB* const pEvent)
+{
+  pEvent->count++;
+  return OS_NO_ERROR;
+}
+
+OS_ERROR OS_SemaphoreWait(OS_ECB* const pEvent, const uint32_t timeout)
+{
+  // Nothing else would ever signal it - the wait lasts until the DMA has filled the next block
+  if (pEvent->count == 0)
+    FillBlock();
+
+  if (!CHECK(pEvent->count > 0))
+    return OS_TIMEOUT;
+
+  pEvent->count--;
+  return OS_NO_ERROR;
+}
+
+void OS_HostDisableInterrupts(void)
+{
+}
+
+void OS_HostEnableInterrupts(void)
+{
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,285 @@
+/*! @file
+ *
+ *  @brief Host test of the kernel benchmark and its COMMAND_BENCHMARK replies.
+ *
+ *  Gives Benchmark_Init a scripted cycle counter, so every run takes a known number of cycles, and checks
+ *  that the cost of reading the counter is taken off, that the fastest, average and slowest runs come
+ *  out right across a counter wrap, that no runs or an unknown kernel are refused, and that the legacy
+ *  replies saturate at 0xFFFF while the extended one carries the whole count. handle.c, the UART driver
+ *  and libOS are replaced by the stand-ins at the end of this file.
+ *
+ *    build/test_benchmark
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup test_benchmark_module test_benchmark module documentation
+**  @{
+*/
+/* MODULE test_benchmark */
+
+#include <string.h>
+
+#include "check.h"
+#include "Benchmark.h"
+#include "OS.h"
+#include "UART.h"
+#include "handle.h"
+#include "packet.h"
+
+// Longest script of run lengths
+#define MAX_SCRIPT 32
+// Legacy replies kept - one benchmark sends three
+#define MAX_REPLIES 4
+
+// Scripted counter - each run reads it twice and takes the next length in Script
+static uint32_t Script[MAX_SCRIPT];
+static uint8_t ScriptLength;
+static uint8_t ScriptPosition;
+static uint32_t Count;
+static bool Running;
+static uint16_t NbReads;
+
+// The handler Benchmark_Init registers, and what it sent
+static Handle_Command_t Handler;
+static uint8_t Replies[MAX_REPLIES][PACKET_NB_BYTES];
+static uint8_t NbReplies;
+static uint8_t Frame[PACKET_FRAME_MAX_SIZE];
+static uint16_t FrameLength;
+
+/*! @brief The scripted cycle counter.
+ *
+ *  Reads at the start of a run give the count, reads at the end add the next run length to it first.
+ */
+static uint32_t FakeCounter(void)
+{
+  NbReads++;
+
+  if (Running && (ScriptPosition < ScriptLength))
+    Count += Script[ScriptPosition++];
+
+  Running = !Running;
+  return Count;
+}
+
+/*! @brief Scripts the next run lengths, starting the counter at start.
+ *
+ */
+static void SetScript(const uint32_t start, const uint32_t* const lengths, const uint8_t nbLengths)
+{
+  memcpy(Script, lengths, nbLengths * sizeof(lengths[0]));
+  ScriptLength = nbLengths;
+  ScriptPosition = 0;
+  Count = start;
+  Running = false;
+  NbReads = 0;
+}
+
+/*! @brief Sends COMMAND_BENCHMARK to the registered handler.
+ *
+ */
+static bool Command(const uint8_t kernel, const uint16_t runs)
+{
+  TPacket packet;
+
+  Packet_Command(&packet) = COMMAND_BENCHMARK;
+  Packet_Parameter1(&packet) = kernel;
+  Packet_Parameter2(&packet) = (uint8_t)runs;
+  Packet_Parameter3(&packet) = (uint8_t)(runs >> 8);
+
+  NbReplies = 0;
+  FrameLength = 0;
+  return Handler(&packet);
+}
+
+/*! @brief Checks a legacy reply.
+ *
+ */
+static void CheckReply(const uint8_t replyNb, const TBenchmarkReply reply, const uint16_t count)
+{
+  CHECK_EQUAL(Replies[replyNb][0], COMMAND_BENCHMARK);
+  CHECK_EQUAL(Replies[replyNb][1], reply);
+  CHECK_EQUAL(Replies[replyNb][2] | (Replies[replyNb][3] << 8), count);
+}
+
+/*! @brief Reads a little endian count from the extended reply.
+ *
+ */
+static uint32_t FrameUInt32(const uint16_t offset)
+{
+  const uint8_t* const bytes = &Frame[PACKET_FRAME_HEADER_SIZE + offset];
+
+  return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static void TestInit(void)
+{
+  CHECK(!Benchmark_Init(NULL));
+  CHECK(Benchmark_Init(FakeCounter));
+  CHECK(Handler != NULL);
+}
+
+static void TestRefused(void)
+{
+  TBenchmarkResult result;
+
+  SetScript(0, NULL, 0);
+  CHECK(!Benchmark_Run(BENCHMARK_KERNEL_RMS, 0, &result));
+  CHECK(!Benchmark_Run(BENCHMARK_NB_KERNELS, 1, &result));
+  CHECK(!Benchmark_Run((TBenchmarkKernel)0xFF, 1, &result));
+  CHECK_EQUAL(NbReads, 0);
+
+  (void)Packet_SetProtocol(PACKET_PROTOCOL_LEGACY);
+  CHECK(!Command(BENCHMARK_NB_KERNELS, 1));
+  CHECK(!Command(BENCHMARK_KERNEL_CRC, 0));
+  CHECK_EQUAL(NbReplies, 0);
+}
+
+static void TestOverhead(void)
+{
+  // 16 empty runs, the fastest 10 cycles, then the kernel - one run faster than the overhead itself
+  static const uint32_t lengths[] =
+  {
+    14, 12, 11, 10, 13, 12, 12, 15, 11, 10, 12, 11, 13, 14, 12, 11,
+    110, 60, 40, 9
+  };
+  TBenchmarkResult result;
+
+  SetScript(1000, lengths, sizeof(lengths) / sizeof(lengths[0]));
+  CHECK(Benchmark_Run(BENCHMARK_KERNEL_CRC, 4, &result));
+  CHECK_EQUAL(NbReads, 2 * (16 + 4));
+  CHECK_EQUAL(result.runs, 4);
+  CHECK_EQUAL(result.min, 0);
+  CHECK_EQUAL(result.max, 100);
+  CHECK_EQUAL(result.average, (100 + 50 + 30 + 0) / 4);
+}
+
+static void TestWrap(void)
+{
+  // The overhead is only measured once, and a run may straddle the counter wrapping
+  static const uint32_t lengths[] = {20, 31, 25};
+  TBenchmarkResult result;
+
+  SetScript(UINT32_MAX - 40, lengths, sizeof(lengths) / sizeof(lengths[0]));
+  CHECK(Benchmark_Run(BENCHMARK_KERNEL_PACKET, 3, &result));
+  CHECK_EQUAL(NbReads, 2 * 3);
+  CHECK_EQUAL(result.min, 10);
+  CHECK_EQUAL(result.max, 21);
+  CHECK_EQUAL(result.average, (10 + 21 + 15) / 3);
+}
+
+static void TestLegacyReply(void)
+{
+  // 70000, 5 and 100000 cycles once the overhead is off
+  static const uint32_t lengths[] = {70010, 15, 100010};
+  // 0xFFFF and 0x10000 cycles
+  static const uint32_t limit[] = {0xFFFF + 10, 0x10000 + 10};
+
+  (void)Packet_SetProtocol(PACKET_PROTOCOL_LEGACY);
+  SetScript(0, lengths, sizeof(lengths) / sizeof(lengths[0]));
+  CHECK(Command(BENCHMARK_KERNEL_FRAME, 3));
+  CHECK_EQUAL(NbReplies, 3);
+  CheckReply(0, BENCHMARK_REPLY_MIN, 5);
+  CheckReply(1, BENCHMARK_REPLY_AVERAGE, (70000 + 5 + 100000) / 3);
+  CheckReply(2, BENCHMARK_REPLY_MAX, 0xFFFF);
+
+  // Just past 16 bits saturates rather than wrapping to 0
+  SetScript(0, limit, 2);
+  CHECK(Command(BENCHMARK_KERNEL_RMS, 2));
+  CHECK_EQUAL(NbReplies, 3);
+  CheckReply(0, BENCHMARK_REPLY_MIN, 0xFFFF);
+  CheckReply(1, BENCHMARK_REPLY_AVERAGE, 0xFFFF);
+  CheckReply(2, BENCHMARK_REPLY_MAX, 0xFFFF);
+}
+
+static void TestExtendedReply(void)
+{
+  static const uint32_t lengths[] = {70010, 15, 100010};
+
+  (void)Packet_SetProtocol(PACKET_PROTOCOL_EXTENDED);
+  SetScript(0, lengths, sizeof(lengths) / sizeof(lengths[0]));
+  CHECK(Command(BENCHMARK_KERNEL_FRAME, 3));
+  CHECK_EQUAL(NbReplies, 0);
+  if (!CHECK_EQUAL(FrameLength, PACKET_FRAME_HEADER_SIZE + 15 + PACKET_FRAME_TRAILER_SIZE))
+    return;
+
+  CHECK_EQUAL(Frame[PACKET_FRAME_HEADER_SIZE], BENCHMARK_KERNEL_FRAME);
+  CHECK_EQUAL(Frame[PACKET_FRAME_HEADER_SIZE + 1] | (Frame[PACKET_FRAME_HEADER_SIZE + 2] << 8), 3);
+  CHECK_EQUAL(FrameUInt32(3), 5);
+  CHECK_EQUAL(FrameUInt32(7), (70000 + 5 + 100000) / 3);
+  CHECK_EQUAL(FrameUInt32(11), 100000);
+}
+
+int main(void)
+{
+  TestInit();
+  TestRefused();
+  TestOverhead();
+  TestWrap();
+  TestLegacyReply();
+  TestExtendedReply();
+
+  return CheckDone("test_benchmark");
+}
+
+/* Stand-ins for handle.c, the UART driver and libOS */
+
+bool Handle_Register(const uint8_t command, const Handle_Command_t handler)
+{
+  if (command != COMMAND_BENCHMARK)
+    return false;
+
+  Handler = handler;
+  return true;
+}
+
+bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  return true;
+}
+
+bool UART_InChar(uint8_t* const dataPtr)
+{
+  return false;
+}
+
+bool UART_OutFrame(const uint8_t* const data, const uint8_t length)
+{
+  if ((length != PACKET_NB_BYTES) || (NbReplies == MAX_REPLIES))
+    return false;
+
+  memcpy(Replies[NbReplies++], data, length);
+  return true;
+}
+
+bool UART_OutBuffer(const uint8_t* const data, const uint16_t length, volatile bool* const busy)
+{
+  if (length > sizeof(Frame))
+    return false;
+
+  memcpy(Frame, data, length);
+  FrameLength = length;
+  *busy = false;
+  return true;
+}
+
+OS_ECB* OS_SemaphoreCreate(const uint32_t value)
+{
+  static OS_ECB semaphore;
+
+  semaphore.count = value;
+  return &semaphore;
+}
+
+void OS_HostDisableInterrupts(void)
+{
+}
+
+void OS_HostEnableInterrupts(void)
+{
+}
+
+/*!
+** @}
+*/
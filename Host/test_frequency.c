@@ -0,0 +1,132 @@
+/*! @file
+ *
+ *  @brief Host test of the frequency estimator.
+ *
+ *  Feeds Frequency_Update synthetic mains waveforms at the firmware's sample rate and averaging - steady
+ *  frequencies across the 47 to 53 Hz band and a sweep across it, with and without noise - and checks
+ *  every published estimate against the true frequency over the same cycles to 0.01 Hz.
+ *
+ *    build/test_frequency
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup test_frequency_module test_frequency module documentation
+**  @{
+*/
+/* MODULE test_frequency */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "check.h"
+#include "Frequency.h"
+
+// Same as the firmware - 800 Hz sampling, averaged over 4 cycles
+#define SAMPLE_RATE 800
+#define NB_CYCLES 4
+// 2.5 V RMS in ADC counts
+#define PEAK (3276.7 * 2.5 * M_SQRT2)
+// Most error allowed, in the estimator's 0.01 Hz units
+#define TOLERANCE 1
+
+/*! @brief xorshift32, so every run gets the same noise.
+ *
+ */
+static uint32_t Random(void)
+{
+  static uint32_t state = 2463534242u;
+
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/*! @brief Runs the estimator over a linear sweep and checks every estimate.
+ *
+ *  @param from The frequency at the start, in Hz.
+ *  @param to The frequency at the end, in Hz.
+ *  @param seconds The length of the sweep.
+ *  @param noise The peak of the uniform noise added, in ADC counts.
+ *  @return uint32_t - The number of estimates checked.
+ */
+static uint32_t Sweep(const double from, const double to, const double seconds, const int noise)
+{
+  TFrequencyEstimator estimator;
+  // True times of the rising zero crossings, in samples
+  double crossings[NB_CYCLES + 1] = {0};
+  uint32_t nbCrossings = 0, nbChecked = 0, worst = 0;
+  uint32_t nbSamples = (uint32_t)(seconds * SAMPLE_RATE);
+  double cycles = 0.25;
+
+  if (!CHECK(Frequency_Init(&estimator, SAMPLE_RATE, NB_CYCLES)))
+    return 0;
+
+  for (uint32_t sampleNb = 0; sampleNb < nbSamples; sampleNb++)
+  {
+    double frequency = from + (to - from) * sampleNb / nbSamples;
+    double next = cycles + frequency / SAMPLE_RATE;
+    int32_t value = (int32_t)lround(PEAK * sin(2 * M_PI * next));
+    bool crossed = floor(next) != floor(cycles);
+
+    if (noise)
+      value += (int32_t)(Random() % (2 * noise + 1)) - noise;
+
+    if (crossed)
+    {
+      // The phase is as good as linear over one sample
+      for (uint8_t crossingNb = 0; crossingNb < NB_CYCLES; crossingNb++)
+        crossings[crossingNb] = crossings[crossingNb + 1];
+      crossings[NB_CYCLES] = sampleNb + (floor(next) - cycles) / (next - cycles);
+      nbCrossings++;
+    }
+    cycles = next;
+
+    Frequency_Update(&estimator, (int16_t)value);
+
+    // Every crossing after the first NB_CYCLES republishes, from the same cycles as the truth
+    if (crossed && (nbCrossings > NB_CYCLES + 1))
+    {
+      long truth = lround(100.0 * NB_CYCLES * SAMPLE_RATE / (crossings[NB_CYCLES] - crossings[0]));
+      uint32_t error = (uint32_t)labs((long)Frequency_Get(&estimator) - truth);
+
+      if (error > worst)
+        worst = error;
+      nbChecked++;
+    }
+  }
+
+  if (!CHECK(worst <= TOLERANCE))
+    fprintf(stderr, "  %.2f to %.2f Hz, noise %d: worst error %u.%02u Hz\n", from, to, noise, worst / 100, worst % 100);
+
+  return nbChecked;
+}
+
+int main(void)
+{
+  TFrequencyEstimator estimator;
+
+  // Nothing is published until NB_CYCLES whole cycles have been seen
+  CHECK(Frequency_Init(&estimator, SAMPLE_RATE, NB_CYCLES));
+  CHECK_EQUAL(Frequency_Get(&estimator), 0);
+  CHECK(!Frequency_Init(&estimator, SAMPLE_RATE, 0));
+  CHECK(!Frequency_Init(&estimator, SAMPLE_RATE, FREQUENCY_MAX_CYCLES + 1));
+  CHECK(!Frequency_Init(&estimator, 0, NB_CYCLES));
+
+  // Steady frequencies across the band, including ones that do not divide the sample rate
+  for (double frequency = 47.0; frequency <= 53.0; frequency += 0.37)
+    CHECK(Sweep(frequency, frequency, 5, 0) > 0);
+
+  // A drift across the whole band, clean and with 5 mV of noise
+  CHECK(Sweep(47.0, 53.0, 60, 0) > 2000);
+  CHECK(Sweep(53.0, 47.0, 60, 0) > 2000);
+  CHECK(Sweep(47.0, 53.0, 60, 16) > 2000);
+
+  return CheckDone("test_frequency");
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,293 @@
+/*! @file
+ *
+ *  @brief Host test of the packet parsers in an extended session.
+ *
+ *  Feeds Packet_Get valid, corrupt and bulk extended frames - including ones whose last five bytes happen
+ *  to make a valid legacy packet - and checks that only the valid command frames are dispatched and that
+ *  the session stays extended, then that a real legacy packet between frames still drops it back to legacy.
+ *  The UART driver and libOS are replaced by the stand-ins at the end of this file.
+ *
+ *    build/test_packet
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup test_packet_module test_packet module documentation
+**  @{
+*/
+/* MODULE test_packet */
+
+#include <string.h>
+
+#include "check.h"
+#include "CRC.h"
+#include "OS.h"
+#include "UART.h"
+#include "packet.h"
+
+// Bytes fed in one go - more than any frame
+#define IN_SIZE (4 * PACKET_FRAME_MAX_SIZE)
+// Random bulk frames fed in one run
+#define NB_BULK_FRAMES 2000
+
+// Stand-in UART - Packet_Get reads from In
+static uint8_t In[IN_SIZE];
+static uint16_t InLength;
+static uint16_t InPosition;
+
+/*! @brief xorshift32, so every run gets the same frames.
+ *
+ */
+static uint32_t Random(void)
+{
+  static uint32_t state = 2463534242u;
+
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/*! @brief Starts an extended session with nothing received.
+ *
+ */
+static void Restart(void)
+{
+  InLength = 0;
+  InPosition = 0;
+  (void)Packet_SetProtocol(PACKET_PROTOCOL_EXTENDED);
+}
+
+/*! @brief Parses everything fed so far.
+ *
+ *  @param packets Where the dispatched packets are copied, or NULL.
+ *  @param maxPackets The most packets copied.
+ *  @return uint32_t - The number of packets dispatched.
+ */
+static uint32_t Dispatch(TPacket* const packets, const uint32_t maxPackets)
+{
+  TPacket packet;
+  uint32_t nbPackets = 0;
+
+  while (Packet_Get(&packet))
+  {
+    if (packets && (nbPackets < maxPackets))
+      packets[nbPackets] = packet;
+    nbPackets++;
+  }
+
+  return nbPackets;
+}
+
+/*! @brief Appends a frame with the payload already at In[InLength + PACKET_FRAME_HEADER_SIZE].
+ *
+ *  @return uint8_t* - The frame.
+ */
+static uint8_t* Seal(const uint8_t command, const uint16_t length)
+{
+  uint8_t* frame = &In[InLength];
+
+  InLength += Packet_FrameSeal(frame, command, length);
+  return frame;
+}
+
+/*! @brief XOR of the last five bytes fed - zero if they look like a legacy packet.
+ *
+ */
+static uint8_t TailChecksum(void)
+{
+  return In[InLength - 1] ^ In[InLength - 2] ^ In[InLength - 3] ^ In[InLength - 4] ^ In[InLength - 5];
+}
+
+static void TestCommandFrame(void)
+{
+  TPacket packet;
+
+  Restart();
+  In[InLength + PACKET_FRAME_HEADER_SIZE] = 0x12;
+  In[InLength + PACKET_FRAME_HEADER_SIZE + 1] = 0x34;
+  In[InLength + PACKET_FRAME_HEADER_SIZE + 2] = 0x56;
+  (void)Seal(0x04, PACKET_FRAME_COMMAND_PAYLOAD);
+
+  if (CHECK_EQUAL(Dispatch(&packet, 1), 1))
+  {
+    CHECK_EQUAL(Packet_Command(&packet), 0x04);
+    CHECK_EQUAL(Packet_Parameter1(&packet), 0x12);
+    CHECK_EQUAL(Packet_Parameter2(&packet), 0x34);
+    CHECK_EQUAL(Packet_Parameter3(&packet), 0x56);
+  }
+  CHECK_EQUAL(Packet_GetProtocol(), PACKET_PROTOCOL_EXTENDED);
+}
+
+static void TestBadCRC(void)
+{
+  uint8_t* frame;
+
+  // A command frame whose CRC is wrong, with the CRC bytes picked so the last five bytes XOR to zero
+  Restart();
+  In[InLength + PACKET_FRAME_HEADER_SIZE] = 0x10;
+  In[InLength + PACKET_FRAME_HEADER_SIZE + 1] = 0x20;
+  In[InLength + PACKET_FRAME_HEADER_SIZE + 2] = 0x30;
+  frame = Seal(0x04, PACKET_FRAME_COMMAND_PAYLOAD);
+  frame[PACKET_FRAME_HEADER_SIZE + 3] ^= 0x01;
+  frame[PACKET_FRAME_HEADER_SIZE + 4] ^= TailChecksum();
+
+  CHECK_EQUAL(TailChecksum(), 0);
+  CHECK_EQUAL(Dispatch(NULL, 0), 0);
+  CHECK_EQUAL(Packet_GetProtocol(), PACKET_PROTOCOL_EXTENDED);
+}
+
+static void TestBadLength(void)
+{
+  // A marker that was not one - the length is impossible, and the byte before it makes the five a legacy packet
+  Restart();
+  In[InLength++] = PACKET_FRAME_MARKER ^ 0x05;
+  In[InLength++] = PACKET_FRAME_MARKER;
+  In[InLength++] = 0x05;
+  In[InLength++] = 0xFF;
+  In[InLength++] = 0xFF;
+
+  CHECK_EQUAL(TailChecksum(), 0);
+  CHECK_EQUAL(Dispatch(NULL, 0), 0);
+  CHECK_EQUAL(Packet_GetProtocol(), PACKET_PROTOCOL_EXTENDED);
+}
+
+static void TestBulkFrames(void)
+{
+  uint32_t nbLookalikes = 0, nbPackets = 0;
+
+  // Valid frames that are not commands, some of them ending in what looks like a legacy packet
+  Restart();
+  for (uint32_t frameNb = 0; frameNb < NB_BULK_FRAMES; frameNb++)
+  {
+    uint16_t length = PACKET_FRAME_COMMAND_PAYLOAD + 1 + Random() % (PACKET_FRAME_MAX_PAYLOAD - PACKET_FRAME_COMMAND_PAYLOAD);
+
+    InLength = 0;
+    InPosition = 0;
+    for (uint16_t byteNb = 0; byteNb < length; byteNb++)
+      In[PACKET_FRAME_HEADER_SIZE + byteNb] = (uint8_t)Random();
+    (void)Seal(0x30, length);
+
+    if (TailChecksum() == 0)
+      nbLookalikes++;
+
+    nbPackets += Dispatch(NULL, 0);
+  }
+
+  CHECK(nbLookalikes > 0);
+  CHECK_EQUAL(nbPackets, 0);
+  CHECK_EQUAL(Packet_GetProtocol(), PACKET_PROTOCOL_EXTENDED);
+}
+
+static void TestCorruptFrames(void)
+{
+  uint32_t nbPackets = 0;
+
+  // Random damage to command and bulk frames - a flipped bit still passing the CRC would be a CRC-16 miss
+  Restart();
+  for (uint32_t frameNb = 0; frameNb < NB_BULK_FRAMES; frameNb++)
+  {
+    uint16_t length = (frameNb & 1) ? PACKET_FRAME_COMMAND_PAYLOAD : (1 + Random() % 64);
+    uint16_t size;
+
+    InLength = 0;
+    InPosition = 0;
+    for (uint16_t byteNb = 0; byteNb < length; byteNb++)
+      In[PACKET_FRAME_HEADER_SIZE + byteNb] = (uint8_t)Random();
+    size = Packet_FrameSeal(In, 0x04, length);
+    InLength = size;
+    // Anywhere but the marker, so the frame is still parsed as one
+    In[1 + Random() % (size - 1)] ^= (uint8_t)(1 << (Random() % 8));
+
+    nbPackets += Dispatch(NULL, 0);
+    // Drop whatever an over-long length is still waiting for
+    (void)Packet_SetProtocol(PACKET_PROTOCOL_EXTENDED);
+  }
+
+  CHECK_EQUAL(nbPackets, 0);
+  CHECK_EQUAL(Packet_GetProtocol(), PACKET_PROTOCOL_EXTENDED);
+}
+
+static void TestLegacyFallback(void)
+{
+  static const uint8_t Legacy[PACKET_NB_BYTES] = {0x04, 0x01, 0x02, 0x03, 0x04 ^ 0x01 ^ 0x02 ^ 0x03};
+  TPacket packets[2];
+
+  // A command frame and then a legacy tool taking over
+  Restart();
+  In[InLength + PACKET_FRAME_HEADER_SIZE] = 0x00;
+  In[InLength + PACKET_FRAME_HEADER_SIZE + 1] = 0x00;
+  In[InLength + PACKET_FRAME_HEADER_SIZE + 2] = 0x00;
+  (void)Seal(0x09, PACKET_FRAME_COMMAND_PAYLOAD);
+  memcpy(&In[InLength], Legacy, sizeof(Legacy));
+  InLength += sizeof(Legacy);
+
+  if (CHECK_EQUAL(Dispatch(packets, 2), 2))
+  {
+    CHECK_EQUAL(Packet_Command(&packets[0]), 0x09);
+    CHECK(memcmp(packets[1].bytes, Legacy, sizeof(Legacy)) == 0);
+  }
+  CHECK_EQUAL(Packet_GetProtocol(), PACKET_PROTOCOL_LEGACY);
+}
+
+int main(void)
+{
+  CHECK(Packet_Init(115200, 25000000));
+
+  TestCommandFrame();
+  TestBadCRC();
+  TestBadLength();
+  TestBulkFrames();
+  TestCorruptFrames();
+  TestLegacyFallback();
+
+  return CheckDone("test_packet");
+}
+
+/* Stand-ins for the UART driver and libOS */
+
+bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  return true;
+}
+
+bool UART_InChar(uint8_t* const dataPtr)
+{
+  if (InPosition == InLength)
+    return false;
+
+  *dataPtr = In[InPosition++];
+  return true;
+}
+
+bool UART_OutFrame(const uint8_t* const data, const uint8_t length)
+{
+  return true;
+}
+
+bool UART_OutBuffer(const uint8_t* const data, const uint16_t length, volatile bool* const busy)
+{
+  *busy = false;
+  return true;
+}
+
+OS_ECB* OS_SemaphoreCreate(const uint32_t value)
+{
+  static OS_ECB semaphore;
+
+  semaphore.count = value;
+  return &semaphore;
+}
+
+void OS_HostDisableInterrupts(void)
+{
+}
+
+void OS_HostEnableInterrupts(void)
+{
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,106 @@
+/*! @file
+ *
+ *  @brief Routines for hardware-timed acquisition from the LTC1859 ADC.
+ *
+ *  This contains the hand-off of full blocks from the DMA interrupt to the consumer. It has no registers
+ *  in it, so the host build runs it as is against a stand-in for AcquisitionDMA.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Acquisition_module Acquisition module documentation
+**  @{
+*/
+/* MODULE Acquisition */
+
+#include <stddef.h>
+
+#include "Acquisition.h"
+#include "AcquisitionDMA.h"
+#include "OS.h"
+
+// Ping-pong buffers the DMA fills - while one block is being processed the other is filling
+static TAcquisitionSample Samples[2][ACQUISITION_BLOCK_SAMPLES];
+// Timestamp counts of each sample, as the PIT counts them down
+static uint32_t Counts[2][ACQUISITION_BLOCK_SAMPLES];
+
+// Handed from the interrupt to Acquisition_GetBlock
+static volatile uint8_t ReadyBlock;
+static volatile uint32_t BlockCount;
+static uint32_t TakenCount;
+
+static OS_ECB* BlockReady;
+
+static void (*CallbackFuncPtr)(void*);
+static void* CallbackArgs;
+
+bool Acquisition_Init(const uint32_t moduleClk, void (*userFunction)(void*), void* userArguments)
+{
+  CallbackFuncPtr = userFunction;
+  CallbackArgs = userArguments;
+  BlockCount = 0;
+  TakenCount = 0;
+
+  BlockReady = OS_SemaphoreCreate(0);
+
+  return (BlockReady != NULL) && AcquisitionDMA_Init(moduleClk, Samples, Counts);
+}
+
+void Acquisition_Start(const uint32_t period)
+{
+  AcquisitionDMA_Start(period);
+}
+
+bool Acquisition_GetBlock(TAcquisitionBlock* const block)
+{
+  uint32_t count;
+  uint8_t blockNb;
+  bool inTime;
+
+  // A consumer that fell behind has a signal per block but only the latest one is still intact
+  do
+  {
+    (void)OS_SemaphoreWait(BlockReady, 0);
+
+    OS_DisableInterrupts();
+    blockNb = ReadyBlock;
+    count = BlockCount;
+    OS_EnableInterrupts();
+  } while (count == TakenCount);
+
+  // The timer counts down, so its complement counts up
+  block->timestamp = ~Counts[blockNb][0];
+  block->samples = Samples[blockNb];
+
+  block->dropped = count - TakenCount - 1;
+  inTime = (block->dropped == 0);
+  TakenCount = count;
+
+  return inTime;
+}
+
+uint32_t Acquisition_Time(void)
+{
+  return ~AcquisitionDMA_Count();
+}
+
+void Acquisition_Hold(const bool hold)
+{
+  AcquisitionDMA_Hold(hold);
+}
+
+void Acquisition_BlockDone(const uint8_t blockNb)
+{
+  ReadyBlock = blockNb;
+  BlockCount++;
+
+  if (CallbackFuncPtr)
+    (*CallbackFuncPtr)(CallbackArgs);
+
+  OS_SemaphoreSignal(BlockReady);
+}
+
+/*!
+** @}
+*/
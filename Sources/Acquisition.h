@@ -0,0 +1,99 @@
+/*! @file
+ *
+ *  @brief Routines for hardware-timed acquisition from the LTC1859 ADC.
+ *
+ *  This contains the functions for sampling the analog inputs on the PIT rather than when a thread gets
+ *  round to it. Every expiry of PIT channel ACQUISITION_PIT_CHANNEL starts one SPI frame per input, and
+ *  the results and a timestamp from PIT channel ACQUISITION_TIMESTAMP_CHANNEL are written into one of two
+ *  blocks of ACQUISITION_BLOCK_SAMPLES samples, all by eDMA (see AcquisitionDMA.h). The CPU does no work
+ *  per sample: once a block is full the DMA moves on to the other one, and one interrupt hands the full
+ *  block to Acquisition_GetBlock. The consumer has until the DMA comes back to the block to process it.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+// new types
+#include "types.h"
+
+// Inputs sampled, from analog input 0
+#define ACQUISITION_NB_CHANNELS 3
+// Samples per block - the consumer wakes once per block
+#define ACQUISITION_BLOCK_SAMPLES 8
+
+// PIT channels owned by the acquisition - the one that starts each sample, and the free-running timestamp
+#define ACQUISITION_PIT_CHANNEL       1
+#define ACQUISITION_TIMESTAMP_CHANNEL 3
+
+/*!
+ * @struct TAcquisitionSample
+ * @brief One sample of every input, as the DMA writes it.
+ */
+typedef struct
+{
+  int16_t unused;                                   /*!< Result of the frame that only starts the first conversion */
+  int16_t values[ACQUISITION_NB_CHANNELS];          /*!< Raw ADC counts, one per input */
+} TAcquisitionSample;
+
+/*!
+ * @struct TAcquisitionBlock
+ * @brief A full block of samples.
+ */
+typedef struct
+{
+  uint32_t timestamp;                               /*!< When the first sample was started, in module clock cycles */
+  const TAcquisitionSample* samples;                /*!< ACQUISITION_BLOCK_SAMPLES samples, oldest first */
+  uint32_t dropped;                                 /*!< Blocks overwritten untaken since the one before */
+} TAcquisitionBlock;
+
+/*! @brief Sets up the acquisition before first use.
+ *
+ *  Call after Analog_Init and PIT_Init - the SPI and PIT modules must be running already.
+ *  @param moduleClk The module clock rate in Hz.
+ *  @param userFunction is a pointer to a function called from the interrupt as each block fills, or NULL.
+ *  @param userArguments is a pointer to the user arguments to use with the user callback function.
+ *  @return bool - TRUE if the acquisition was successfully initialized.
+ */
+bool Acquisition_Init(const uint32_t moduleClk, void (*userFunction)(void*), void* userArguments);
+
+/*! @brief Starts sampling.
+ *
+ *  @param period The sample period in nanoseconds.
+ */
+void Acquisition_Start(const uint32_t period);
+
+/*! @brief Waits for the next full block.
+ *
+ *  A consumer that fell behind gets the latest block - the DMA is already writing over the one before.
+ *  @param block A pointer to where the block is described.
+ *  @return bool - TRUE if no blocks were missed since the last call.
+ */
+bool Acquisition_GetBlock(TAcquisitionBlock* const block);
+
+/*! @brief Reads the timestamp counter.
+ *
+ *  The counter runs on the module clock, so unlike the DWT cycle counter it keeps counting while the
+ *  core is stopped in Wait mode.
+ *  @return uint32_t - Module clock cycles on the same count as TAcquisitionBlock.timestamp, wrapping every
+ *  2^32 cycles, or 0 until Acquisition_Init has started the counter.
+ */
+uint32_t Acquisition_Time(void);
+
+/*! @brief Holds off sampling while something else uses the SPI.
+ *
+ *  @param hold TRUE to wait for the frames in progress and stop starting new ones, FALSE to carry on.
+ *  @note A sample due while held is skipped.
+ */
+void Acquisition_Hold(const bool hold);
+
+/*! @brief Hands over a full block.
+ *
+ *  @param blockNb The block the DMA has just filled, 0 or 1.
+ *  @note Called from the DMA interrupt.
+ */
+void Acquisition_BlockDone(const uint8_t blockNb);
+
+#endif
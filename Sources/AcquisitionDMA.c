@@ -0,0 +1,200 @@
+/*! @file
+ *
+ *  @brief Routines for the eDMA channels behind the acquisition.
+ *
+ *  This contains the functions for sampling the analog inputs on the PIT through eDMA and SPI2.
+ *
+ *  The LTC1859 converts on the rising edge of its chip select and returns the result during the next
+ *  frame, while that frame's command picks the channel to convert next. So each sample is one frame per
+ *  input and a last one whose command is ignored, and the first result is the previous sample's leftover.
+ *
+ *  SPI2 raises one receive request per frame, so the results can only be written in the order they
+ *  arrive: each block holds its samples one after the other, every input of a sample together.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup AcquisitionDMA_module AcquisitionDMA module documentation
+**  @{
+*/
+/* MODULE AcquisitionDMA */
+
+#include "AcquisitionDMA.h"
+#include "MK70F12.h"
+#include "OS.h"
+#include "PIT.h"
+
+// eDMA channels - the first must be the PIT channel, as only channel n can be triggered by PIT channel n
+#define COMMAND_DMA_CHANNEL   ACQUISITION_PIT_CHANNEL
+#define TIMESTAMP_DMA_CHANNEL 2
+#define RESULT_DMA_CHANNEL    3
+// DMAMUX0 request sources - an always enabled slot gated by the PIT trigger, and SPI2 receive
+#define COMMAND_DMAMUX_SOURCE 63
+#define RESULT_DMAMUX_SOURCE  20
+
+// Frames per sample - the last one only collects the last input's result
+#define NB_FRAMES (ACQUISITION_NB_CHANNELS + 1)
+// Frames in both blocks - the result channel's major loop, with its half way interrupt between the blocks
+#define NB_BUFFER_FRAMES (2 * ACQUISITION_BLOCK_SAMPLES * NB_FRAMES)
+
+// SPI2 chip select of the ADC on the TWR-ADCDAC-LTC
+#define ADC_PCS 0x01
+// Clock and transfer attributes register used for the ADC frames, leaving CTAR0 to libAnalog
+#define ADC_CTAR 1
+
+// LTC1859 command byte - single ended, bipolar, +/- 10 V, in the top of the frame
+#define ADC_COMMAND_SGL  0x80
+#define ADC_COMMAND_GAIN 0x04
+#define ADC_COMMAND(channelNb) ((uint16_t)((ADC_COMMAND_SGL | (((channelNb) & 0x01) << 6) | (((channelNb) >> 1) << 4) \
+                                            | ADC_COMMAND_GAIN) << 8))
+
+// A full period in the free-running timestamp channel
+#define TIMESTAMP_RELOAD 0xFFFFFFFFu
+
+// SPI2 PUSHR words for each frame - the DMA copies these to the SPI
+static uint32_t Commands[NB_FRAMES];
+
+// Set once the timestamp channel is running
+static volatile bool Counting;
+
+/*! @brief Sets up the SPI for the ADC frames.
+ *
+ */
+static void InitSPI(void)
+{
+  // 16-bit frames at 25 MHz / 2 / 2 = 6.25 MHz, chip select high for 9 us between frames to cover the conversion
+  SPI_CTAR_REG(SPI2_BASE_PTR, ADC_CTAR) = SPI_CTAR_FMSZ(15) | SPI_CTAR_PBR(0) | SPI_CTAR_BR(0)
+                                        | SPI_CTAR_PDT(3) | SPI_CTAR_DT(4);
+
+  // Receive FIFO drain requests go to the DMA
+  SPI2_RSER |= SPI_RSER_RFDF_RE_MASK | SPI_RSER_RFDF_DIRS_MASK;
+}
+
+/*! @brief Sets up the three eDMA channels.
+ *
+ */
+static void InitDMA(TAcquisitionSample samples[2][ACQUISITION_BLOCK_SAMPLES], uint32_t counts[2][ACQUISITION_BLOCK_SAMPLES])
+{
+  SIM_SCGC6 |= SIM_SCGC6_DMAMUX0_MASK;
+  SIM_SCGC7 |= SIM_SCGC7_DMA_MASK;
+
+  // Commands - the whole sample on every PIT trigger, then start the timestamp channel
+  DMAMUX0_CHCFG(COMMAND_DMA_CHANNEL) = 0;
+  DMA_SADDR(COMMAND_DMA_CHANNEL) = (uint32_t)Commands;
+  DMA_SOFF(COMMAND_DMA_CHANNEL) = sizeof(Commands[0]);
+  DMA_ATTR(COMMAND_DMA_CHANNEL) = DMA_ATTR_SSIZE(2) | DMA_ATTR_DSIZE(2);
+  DMA_NBYTES_MLNO(COMMAND_DMA_CHANNEL) = DMA_NBYTES_MLNO_NBYTES(sizeof(Commands));
+  DMA_SLAST(COMMAND_DMA_CHANNEL) = -(int32_t)sizeof(Commands);
+  DMA_DADDR(COMMAND_DMA_CHANNEL) = (uint32_t)&SPI2_PUSHR;
+  DMA_DOFF(COMMAND_DMA_CHANNEL) = 0;
+  DMA_DLAST_SGA(COMMAND_DMA_CHANNEL) = 0;
+  DMA_CITER_ELINKNO(COMMAND_DMA_CHANNEL) = DMA_CITER_ELINKNO_CITER(1);
+  DMA_BITER_ELINKNO(COMMAND_DMA_CHANNEL) = DMA_BITER_ELINKNO_BITER(1);
+  DMA_CSR(COMMAND_DMA_CHANNEL) = DMA_CSR_MAJORELINK_MASK | DMA_CSR_MAJORLINKCH(TIMESTAMP_DMA_CHANNEL);
+  DMAMUX0_CHCFG(COMMAND_DMA_CHANNEL) = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_TRIG_MASK
+                                     | DMAMUX_CHCFG_SOURCE(COMMAND_DMAMUX_SOURCE);
+
+  // Timestamps - one word from the free-running PIT channel into the next slot, only ever started by the link
+  DMA_SADDR(TIMESTAMP_DMA_CHANNEL) = (uint32_t)&PIT_CVAL(ACQUISITION_TIMESTAMP_CHANNEL);
+  DMA_SOFF(TIMESTAMP_DMA_CHANNEL) = 0;
+  DMA_ATTR(TIMESTAMP_DMA_CHANNEL) = DMA_ATTR_SSIZE(2) | DMA_ATTR_DSIZE(2);
+  DMA_NBYTES_MLNO(TIMESTAMP_DMA_CHANNEL) = DMA_NBYTES_MLNO_NBYTES(sizeof(counts[0][0]));
+  DMA_SLAST(TIMESTAMP_DMA_CHANNEL) = 0;
+  DMA_DADDR(TIMESTAMP_DMA_CHANNEL) = (uint32_t)counts;
+  DMA_DOFF(TIMESTAMP_DMA_CHANNEL) = sizeof(counts[0][0]);
+  DMA_DLAST_SGA(TIMESTAMP_DMA_CHANNEL) = -(int32_t)(2 * sizeof(counts[0]));
+  DMA_CITER_ELINKNO(TIMESTAMP_DMA_CHANNEL) = DMA_CITER_ELINKNO_CITER(2 * ACQUISITION_BLOCK_SAMPLES);
+  DMA_BITER_ELINKNO(TIMESTAMP_DMA_CHANNEL) = DMA_BITER_ELINKNO_BITER(2 * ACQUISITION_BLOCK_SAMPLES);
+  DMA_CSR(TIMESTAMP_DMA_CHANNEL) = 0;
+
+  // Results - a frame per SPI receive request, interrupting as each block fills
+  DMAMUX0_CHCFG(RESULT_DMA_CHANNEL) = 0;
+  DMA_SADDR(RESULT_DMA_CHANNEL) = (uint32_t)&SPI2_POPR;
+  DMA_SOFF(RESULT_DMA_CHANNEL) = 0;
+  DMA_ATTR(RESULT_DMA_CHANNEL) = DMA_ATTR_SSIZE(1) | DMA_ATTR_DSIZE(1);
+  DMA_NBYTES_MLNO(RESULT_DMA_CHANNEL) = DMA_NBYTES_MLNO_NBYTES(sizeof(int16_t));
+  DMA_SLAST(RESULT_DMA_CHANNEL) = 0;
+  DMA_DADDR(RESULT_DMA_CHANNEL) = (uint32_t)samples;
+  DMA_DOFF(RESULT_DMA_CHANNEL) = sizeof(int16_t);
+  DMA_DLAST_SGA(RESULT_DMA_CHANNEL) = -(int32_t)(2 * sizeof(samples[0]));
+  DMA_CITER_ELINKNO(RESULT_DMA_CHANNEL) = DMA_CITER_ELINKNO_CITER(NB_BUFFER_FRAMES);
+  DMA_BITER_ELINKNO(RESULT_DMA_CHANNEL) = DMA_BITER_ELINKNO_BITER(NB_BUFFER_FRAMES);
+  DMA_CSR(RESULT_DMA_CHANNEL) = DMA_CSR_INTHALF_MASK | DMA_CSR_INTMAJOR_MASK;
+  DMAMUX0_CHCFG(RESULT_DMA_CHANNEL) = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(RESULT_DMAMUX_SOURCE);
+
+  // Enable the result channel's NVIC; IRQ = 3
+  NVICICPR0 = (1 << RESULT_DMA_CHANNEL);
+  NVICISER0 = (1 << RESULT_DMA_CHANNEL);
+}
+
+bool AcquisitionDMA_Init(const uint32_t moduleClk, TAcquisitionSample samples[2][ACQUISITION_BLOCK_SAMPLES],
+                         uint32_t counts[2][ACQUISITION_BLOCK_SAMPLES])
+{
+  (void)moduleClk;
+
+  for (uint8_t frameNb = 0; frameNb < NB_FRAMES; frameNb++)
+  {
+    // The last frame's command only sets up a conversion that is never read
+    uint8_t channelNb = (frameNb < ACQUISITION_NB_CHANNELS) ? frameNb : 0;
+
+    Commands[frameNb] = SPI_PUSHR_CTAS(ADC_CTAR) | SPI_PUSHR_PCS(ADC_PCS) | ADC_COMMAND(channelNb);
+  }
+
+  InitSPI();
+  InitDMA(samples, counts);
+
+  // The timestamp channel counts down from all ones, wrapping every 172 s at 25 MHz - it runs from
+  // here rather than from the first sample, as it also times the idle thread's sleeps
+  PIT_LDVAL(ACQUISITION_TIMESTAMP_CHANNEL) = TIMESTAMP_RELOAD;
+  PIT_TCTRL(ACQUISITION_TIMESTAMP_CHANNEL) = PIT_TCTRL_TEN_MASK;
+  Counting = true;
+
+  return true;
+}
+
+void AcquisitionDMA_Start(const uint32_t period)
+{
+  DMA_SERQ = DMA_SERQ_SERQ(RESULT_DMA_CHANNEL);
+  DMA_SERQ = DMA_SERQ_SERQ(COMMAND_DMA_CHANNEL);
+
+  // Only the trigger is used - the channel's interrupt stays off
+  PIT_Set(ACQUISITION_PIT_CHANNEL, period, true);
+}
+
+uint32_t AcquisitionDMA_Count(void)
+{
+  // Reading the PIT before PIT_Init has clocked it would fault
+  return Counting ? PIT_CVAL(ACQUISITION_TIMESTAMP_CHANNEL) : TIMESTAMP_RELOAD;
+}
+
+void AcquisitionDMA_Hold(const bool hold)
+{
+  if (hold)
+  {
+    DMA_CERQ = DMA_CERQ_CERQ(COMMAND_DMA_CHANNEL);
+
+    // Let any frames already queued go out and their results come back
+    while ((SPI2_SR & SPI_SR_TXCTR_MASK) || (DMA_CITER_ELINKNO(RESULT_DMA_CHANNEL) % NB_FRAMES));
+  }
+  else
+  {
+    DMA_SERQ = DMA_SERQ_SERQ(COMMAND_DMA_CHANNEL);
+  }
+}
+
+void __attribute__ ((interrupt)) AcquisitionDMA_ISR(void)
+{
+  OS_ISREnter();
+
+  DMA_CINT = DMA_CINT_CINT(RESULT_DMA_CHANNEL);
+
+  // The half way interrupt leaves the count at half, the major loop reloads it
+  Acquisition_BlockDone((DMA_CITER_ELINKNO(RESULT_DMA_CHANNEL) > (NB_BUFFER_FRAMES / 2)) ? 1 : 0);
+
+  OS_ISRExit();
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,56 @@
+/*! @file
+ *
+ *  @brief Routines for the eDMA channels behind the acquisition.
+ *
+ *  This contains the functions for chaining the SPI transactions to the LTC1859 with eDMA. Each trigger
+ *  from the PIT queues a frame per input; the results and the timestamp of each sample go to the next
+ *  slot of a buffer of two blocks, with an interrupt when either block is full, which is passed on to
+ *  Acquisition_BlockDone.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef ACQUISITION_DMA_H
+#define ACQUISITION_DMA_H
+
+// new types
+#include "types.h"
+#include "Acquisition.h"
+
+/*! @brief Sets up the SPI and eDMA channels before first use, and starts the timestamp channel.
+ *
+ *  @param moduleClk The module clock rate in Hz.
+ *  @param samples The two blocks of samples, one after the other.
+ *  @param counts The two blocks of timestamp counts, one after the other, as the PIT counts them down.
+ *  @return bool - TRUE if the DMA was successfully initialized.
+ */
+bool AcquisitionDMA_Init(const uint32_t moduleClk, TAcquisitionSample samples[2][ACQUISITION_BLOCK_SAMPLES],
+                         uint32_t counts[2][ACQUISITION_BLOCK_SAMPLES]);
+
+/*! @brief Starts the triggers.
+ *
+ *  @param period The sample period in nanoseconds.
+ */
+void AcquisitionDMA_Start(const uint32_t period);
+
+/*! @brief Reads the timestamp channel.
+ *
+ *  @return uint32_t - The count, as the PIT counts it down in module clock cycles, or all ones until
+ *  AcquisitionDMA_Init has started it.
+ */
+uint32_t AcquisitionDMA_Count(void);
+
+/*! @brief Stops or restarts the triggers.
+ *
+ *  @param hold TRUE to wait for the frames in progress and stop starting new ones, FALSE to carry on.
+ */
+void AcquisitionDMA_Hold(const bool hold);
+
+/*! @brief Interrupt service routine for the eDMA channel that takes the results.
+ *
+ *  Works out which block is full and hands it to Acquisition_BlockDone.
+ */
+void __attribute__ ((interrupt)) AcquisitionDMA_ISR(void);
+
+#endif
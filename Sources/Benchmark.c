@@ -0,0 +1,236 @@
+/*! @file
+ *
+ *  @brief Routines to time the firmware's kernels on the tower.
+ *
+ *  This contains the functions for running a kernel a number of times under a cycle counter and
+ *  reporting the fastest, average and slowest run over the serial link.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Benchmark_module Benchmark module documentation
+**  @{
+*/
+/* MODULE Benchmark */
+
+#include "Benchmark.h"
+#include "CRC.h"
+#include "OS.h"
+#include "RMS.h"
+#include "handle.h"
+
+// Runs of an empty kernel used to find the cost of reading the counter
+#define NB_OVERHEAD_RUNS 16
+
+// Frame reply - kernel, runs, then min, average and max
+#define BENCHMARK_FRAME_PAYLOAD (1 + 2 + 3 * 4)
+
+static TBenchmarkCounter Counter;
+static uint32_t Overhead;
+
+// Kernel inputs - a 2.5 V RMS window of every channel, a largest payload, a packet and a frame
+static const int16_t Sine[MAX_SAMPLE_SIZE] =
+{
+  0, 4434, 8192, 10703, 11585, 10703, 8192, 4434, 0, -4434, -8192, -10703, -11585, -10703, -8192, -4434
+};
+static int16_t Window[MAX_SAMPLE_SIZE][RMS_NB_CHANNELS];
+static uint8_t Payload[PACKET_FRAME_MAX_PAYLOAD];
+static uint8_t Packet[PACKET_NB_BYTES];
+static uint8_t Frame[PACKET_FRAME_HEADER_SIZE + PACKET_FRAME_COMMAND_PAYLOAD + PACKET_FRAME_TRAILER_SIZE];
+static uint16_t FrameSize;
+
+// Results the compiler cannot see are unused
+static volatile uint32_t Sink;
+
+static void RunNothing(void)
+{
+}
+
+static void RunRMS(void)
+{
+  int16_t rms[RMS_NB_CHANNELS];
+
+  RMS_CalculateAll(Window, MAX_SAMPLE_SIZE, rms);
+  Sink = rms[0] + rms[1] + rms[2];
+}
+
+static void RunCRC(void)
+{
+  Sink = CRC_Calculate16(CRC_16_INIT, Payload, sizeof(Payload));
+}
+
+static void RunPacket(void)
+{
+  TPacketParser parser;
+  TPacket packet;
+
+  Packet_ParserInit(&parser);
+  for (uint8_t byteNb = 0; byteNb < PACKET_NB_BYTES; byteNb++)
+    Sink = Packet_ParserFeed(&parser, Packet[byteNb], &packet);
+}
+
+static void RunFrame(void)
+{
+  TFrameParser parser;
+  TPacket packet;
+
+  Packet_FrameParserInit(&parser);
+  for (uint16_t byteNb = 0; byteNb < FrameSize; byteNb++)
+    Sink = Packet_FrameParserFeed(&parser, Frame[byteNb], &packet);
+}
+
+static void (* const Kernels[BENCHMARK_NB_KERNELS])(void) =
+{
+  [BENCHMARK_KERNEL_RMS] = RunRMS,
+  [BENCHMARK_KERNEL_CRC] = RunCRC,
+  [BENCHMARK_KERNEL_PACKET] = RunPacket,
+  [BENCHMARK_KERNEL_FRAME] = RunFrame
+};
+
+/*! @brief Times one run of a kernel.
+ *
+ *  @return uint32_t - The cycles taken, including reading the counter.
+ */
+static uint32_t Time(void (* const kernel)(void))
+{
+  uint32_t start, cycles;
+
+  OS_DisableInterrupts();
+  start = Counter();
+  kernel();
+  cycles = Counter() - start;
+  OS_EnableInterrupts();
+
+  return cycles;
+}
+
+/*! @brief Sends a count in a legacy packet.
+ *
+ *  @return bool - TRUE if the packet was queued.
+ */
+static bool PutCount(const TBenchmarkReply reply, const uint32_t count)
+{
+  uint16union_t value;
+
+  value.l = (count > 0xFFFF) ? 0xFFFF : (uint16_t)count;
+  return Packet_Put(COMMAND_BENCHMARK, reply, value.s.Lo, value.s.Hi);
+}
+
+/*! @brief Writes a count into a frame payload.
+ *
+ */
+static void PutUInt32(uint8_t* const buffer, const uint32_t value)
+{
+  buffer[0] = (uint8_t)value;
+  buffer[1] = (uint8_t)(value >> 8);
+  buffer[2] = (uint8_t)(value >> 16);
+  buffer[3] = (uint8_t)(value >> 24);
+}
+
+/*! @brief Handles COMMAND_BENCHMARK.
+ *
+ *  @param packet A pointer to the received packet.
+ *  @return bool - TRUE if the kernel was timed and the result sent.
+ */
+static bool HandleBenchmarkCommand(const TPacket* const packet)
+{
+  TBenchmarkResult result;
+  uint8_t payload[BENCHMARK_FRAME_PAYLOAD];
+
+  if (!Benchmark_Run((TBenchmarkKernel)Packet_Parameter1(packet), Packet_Parameter23(packet), &result))
+    return false;
+
+  if (Packet_GetProtocol() == PACKET_PROTOCOL_EXTENDED)
+  {
+    payload[0] = Packet_Parameter1(packet);
+    payload[1] = (uint8_t)result.runs;
+    payload[2] = (uint8_t)(result.runs >> 8);
+    PutUInt32(&payload[3], result.min);
+    PutUInt32(&payload[7], result.average);
+    PutUInt32(&payload[11], result.max);
+
+    return Packet_PutFrame(COMMAND_BENCHMARK, payload, sizeof(payload));
+  }
+
+  return PutCount(BENCHMARK_REPLY_MIN, result.min)
+      && PutCount(BENCHMARK_REPLY_AVERAGE, result.average)
+      && PutCount(BENCHMARK_REPLY_MAX, result.max);
+}
+
+bool Benchmark_Init(const TBenchmarkCounter counter)
+{
+  if (!counter)
+    return false;
+
+  Counter = counter;
+
+  // The same sine on every channel, each a few samples on from the last
+  for (uint8_t sampleNb = 0; sampleNb < MAX_SAMPLE_SIZE; sampleNb++)
+    for (uint8_t channelNb = 0; channelNb < RMS_NB_CHANNELS; channelNb++)
+      Window[sampleNb][channelNb] = Sine[(sampleNb + channelNb * 5) % MAX_SAMPLE_SIZE];
+
+  for (uint16_t byteNb = 0; byteNb < sizeof(Payload); byteNb++)
+    Payload[byteNb] = (uint8_t)(byteNb * 7 + 1);
+
+  Packet[0] = COMMAND_VOLTAGE;
+  Packet[1] = 1;
+  Packet[2] = 0;
+  Packet[3] = 0;
+  Packet[4] = Packet[0] ^ Packet[1] ^ Packet[2] ^ Packet[3];
+
+  Frame[PACKET_FRAME_HEADER_SIZE] = 1;
+  Frame[PACKET_FRAME_HEADER_SIZE + 1] = 0;
+  Frame[PACKET_FRAME_HEADER_SIZE + 2] = 0;
+  FrameSize = Packet_FrameSeal(Frame, COMMAND_VOLTAGE, PACKET_FRAME_COMMAND_PAYLOAD);
+
+  // Measured on the first run, once interrupts are on
+  Overhead = UINT32_MAX;
+
+  return Handle_Register(COMMAND_BENCHMARK, HandleBenchmarkCommand);
+}
+
+bool Benchmark_Run(const TBenchmarkKernel kernel, const uint16_t runs, TBenchmarkResult* const result)
+{
+  uint64_t total = 0;
+
+  if (!Counter || (kernel >= BENCHMARK_NB_KERNELS) || (runs == 0))
+    return false;
+
+  // The fastest empty run is what reading the counter costs
+  if (Overhead == UINT32_MAX)
+  {
+    for (uint8_t runNb = 0; runNb < NB_OVERHEAD_RUNS; runNb++)
+    {
+      uint32_t cycles = Time(RunNothing);
+
+      if (cycles < Overhead)
+        Overhead = cycles;
+    }
+  }
+
+  result->runs = runs;
+  result->min = UINT32_MAX;
+  result->max = 0;
+
+  for (uint16_t runNb = 0; runNb < runs; runNb++)
+  {
+    uint32_t cycles = Time(Kernels[kernel]);
+
+    cycles = (cycles > Overhead) ? (cycles - Overhead) : 0;
+    total += cycles;
+
+    if (cycles < result->min)
+      result->min = cycles;
+    if (cycles > result->max)
+      result->max = cycles;
+  }
+
+  result->average = (uint32_t)(total / runs);
+
+  return true;
+}
+
+/*!
+** @}
+*/
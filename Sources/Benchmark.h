@@ -0,0 +1,81 @@
+/*! @file
+ *
+ *  @brief Routines to time the firmware's kernels on the tower.
+ *
+ *  This contains the functions for running a kernel a number of times under a cycle counter and
+ *  reporting the fastest, average and slowest run over the serial link.
+ *
+ *  COMMAND_BENCHMARK has the kernel in parameter 1 and the number of runs in parameters 2 and 3. In an
+ *  extended session the reply is one frame of [kernel, runs lo, runs hi, min, average, max], each count a
+ *  little endian uint32_t. A legacy session gets three packets with BENCHMARK_REPLY_MIN, _AVERAGE and
+ *  _MAX in parameter 1 and the count in parameters 2 and 3, saturating at 0xFFFF.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// new types
+#include "types.h"
+
+/*! @brief Parameter 1 of COMMAND_BENCHMARK.
+ *
+ */
+typedef enum
+{
+  BENCHMARK_KERNEL_RMS,     /*!< RMS_CalculateAll of one 16 sample window of every channel. */
+  BENCHMARK_KERNEL_CRC,     /*!< CRC_Calculate16 of a largest frame payload. */
+  BENCHMARK_KERNEL_PACKET,  /*!< Packet_ParserFeed of one 5 byte packet. */
+  BENCHMARK_KERNEL_FRAME,   /*!< Packet_FrameParserFeed of one command frame. */
+  BENCHMARK_NB_KERNELS
+} TBenchmarkKernel;
+
+/*! @brief Parameter 1 of the legacy COMMAND_BENCHMARK replies.
+ *
+ */
+typedef enum
+{
+  BENCHMARK_REPLY_MIN = 0x80,
+  BENCHMARK_REPLY_AVERAGE,
+  BENCHMARK_REPLY_MAX
+} TBenchmarkReply;
+
+/*! @brief Cycle counts of a kernel.
+ *
+ */
+typedef struct
+{
+  uint16_t runs;            /*!< Number of runs */
+  uint32_t min;             /*!< Fastest run */
+  uint32_t average;         /*!< Mean of the runs, rounded down */
+  uint32_t max;             /*!< Slowest run */
+} TBenchmarkResult;
+
+/*! @brief Reads a free running cycle counter.
+ *
+ *  @return uint32_t - The count, which may wrap.
+ */
+typedef uint32_t (*TBenchmarkCounter)(void);
+
+/*! @brief Sets up the benchmark module before first use.
+ *
+ *  Registers the handler for COMMAND_BENCHMARK. The cost of reading the counter is measured on the first
+ *  run and taken off every run.
+ *  @param counter The cycle counter - DWT_CycleCount on the tower, or a fake one on the host.
+ *  @return bool - TRUE if the benchmark module was successfully initialized.
+ */
+bool Benchmark_Init(const TBenchmarkCounter counter);
+
+/*! @brief Times a kernel.
+ *
+ *  Interrupts are disabled during each run, so the counts do not include the other threads.
+ *  @param kernel The kernel to run.
+ *  @param runs The number of runs.
+ *  @param result A pointer to where the counts are written.
+ *  @return bool - TRUE if the kernel exists and runs is not 0.
+ */
+bool Benchmark_Run(const TBenchmarkKernel kernel, const uint16_t runs, TBenchmarkResult* const result);
+
+#endif
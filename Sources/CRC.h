@@ -0,0 +1,37 @@
+/*! @file
+ *
+ *  @brief Routines to calculate cyclic redundancy checks.
+ *
+ *  This contains the functions for the CRC-16 used by the extended packet frames.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef CRC_H
+#define CRC_H
+
+// new types
+#include "types.h"
+
+// Starting value of a CRC-16/CCITT-FALSE calculation (polynomial 0x1021, not reflected)
+#define CRC_16_INIT 0xFFFF
+
+/*! @brief Adds one byte to a CRC-16.
+ *
+ *  @param crc The CRC so far, or CRC_16_INIT for the first byte.
+ *  @param data The byte to add.
+ *  @return uint16_t - The updated CRC.
+ */
+uint16_t CRC_Update16(const uint16_t crc, const uint8_t data);
+
+/*! @brief Adds a block of bytes to a CRC-16.
+ *
+ *  @param crc The CRC so far, or CRC_16_INIT for the first block.
+ *  @param data A pointer to the bytes to add.
+ *  @param length The number of bytes to add.
+ *  @return uint16_t - The updated CRC.
+ */
+uint16_t CRC_Calculate16(uint16_t crc, const uint8_t* data, uint16_t length);
+
+#endif
@@ -0,0 +1,232 @@
+/*! @file
+ *
+ *  @brief Routines for the ADC sample capture format.
+ *
+ *  This contains the functions for writing and reading captures of the raw samples, so a field event
+ *  can be recorded and played back through the algorithms later.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Capture_module Capture module documentation
+**  @{
+*/
+/* MODULE Capture */
+
+#include <string.h>
+
+#include "Capture.h"
+#include "Varint.h"
+
+static const uint8_t Magic[4] = {'A', 'C', 'A', 'P'};
+
+/*! @brief Little endian field access.
+ *
+ */
+static void Put16(uint8_t* const buffer, const uint16_t value)
+{
+  buffer[0] = (uint8_t)value;
+  buffer[1] = (uint8_t)(value >> 8);
+}
+
+static void Put32(uint8_t* const buffer, const uint32_t value)
+{
+  Put16(buffer, (uint16_t)value);
+  Put16(buffer + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t Get16(const uint8_t* const buffer)
+{
+  return (uint16_t)(buffer[0] | (buffer[1] << 8));
+}
+
+static uint32_t Get32(const uint8_t* const buffer)
+{
+  return Get16(buffer) | ((uint32_t)Get16(buffer + 2) << 16);
+}
+
+uint32_t Capture_ChunkSizeMax(const uint8_t nbChannels, const uint16_t nbSamples)
+{
+  return CAPTURE_CHUNK_HEADER_SIZE + (uint32_t)nbChannels * nbSamples * VARINT_MAX_BYTES_16;
+}
+
+bool Capture_WriteHeader(uint8_t* const buffer, const TCaptureInfo* const info)
+{
+  uint32union_t voltPerBit;
+
+  if ((info->nbChannels == 0) || (info->nbChannels > CAPTURE_MAX_CHANNELS) || (info->samplePeriod == 0))
+    return false;
+
+  memset(buffer, 0, CAPTURE_HEADER_SIZE);
+  memcpy(buffer, Magic, sizeof(Magic));
+  Put16(&buffer[4], CAPTURE_VERSION);
+  Put16(&buffer[6], CAPTURE_HEADER_SIZE);
+  buffer[8] = info->nbChannels;
+  Put32(&buffer[12], info->samplePeriod);
+  memcpy(&voltPerBit.l, &info->voltPerBit, sizeof(voltPerBit.l));
+  Put32(&buffer[16], voltPerBit.l);
+  Put32(&buffer[20], info->nbSamples);
+
+  return true;
+}
+
+uint32_t Capture_EncodeDeltas(uint8_t* const buffer, const int16_t* const samples, const uint8_t nbChannels, const uint16_t nbSamples,
+                              const uint16_t stride)
+{
+  uint32_t length = 0;
+
+  for (uint8_t channelNb = 0; channelNb < nbChannels; channelNb++)
+  {
+    const int16_t* sample = &samples[channelNb];
+    int16_t previous = 0;
+
+    for (uint16_t sampleNb = 0; sampleNb < nbSamples; sampleNb++, sample += stride)
+    {
+      length += Varint_PutSigned(&buffer[length], (int32_t)*sample - previous);
+      previous = *sample;
+    }
+  }
+
+  return length;
+}
+
+uint32_t Capture_WriteChunk(uint8_t* const buffer, const int16_t* const samples, const uint8_t nbChannels,
+                            const uint16_t nbSamples, const uint16_t stride, const TCaptureEncoding encoding)
+{
+  uint8_t* payload = &buffer[CAPTURE_CHUNK_HEADER_SIZE];
+  uint32_t length = 0;
+  TCaptureEncoding used = encoding;
+
+  switch (encoding)
+  {
+    case CAPTURE_ENCODING_DELTA:
+      length = Capture_EncodeDeltas(payload, samples, nbChannels, nbSamples, stride);
+      // Noisy or fast changing signals can come out larger than they went in
+      if (length <= (uint32_t)nbChannels * nbSamples * 2)
+        break;
+      used = CAPTURE_ENCODING_RAW;
+      length = 0;
+      // fall through
+
+    case CAPTURE_ENCODING_RAW:
+      for (uint8_t channelNb = 0; channelNb < nbChannels; channelNb++)
+      {
+        for (uint16_t sampleNb = 0; sampleNb < nbSamples; sampleNb++)
+        {
+          Put16(&payload[length], (uint16_t)samples[sampleNb * stride + channelNb]);
+          length += 2;
+        }
+      }
+      break;
+
+    default:
+      return 0;
+  }
+
+  Put16(&buffer[0], nbSamples);
+  buffer[2] = (uint8_t)used;
+  buffer[3] = 0;
+  Put32(&buffer[4], length);
+
+  return CAPTURE_CHUNK_HEADER_SIZE + length;
+}
+
+bool Capture_ReaderInit(TCaptureReader* const reader, const uint8_t* const data, const uint32_t length)
+{
+  uint32union_t voltPerBit;
+  uint16_t headerSize;
+
+  if ((length < CAPTURE_HEADER_SIZE) || (memcmp(data, Magic, sizeof(Magic)) != 0) || (Get16(&data[4]) != CAPTURE_VERSION))
+    return false;
+
+  // Later headers may be longer, but never shorter
+  headerSize = Get16(&data[6]);
+  if ((headerSize < CAPTURE_HEADER_SIZE) || (headerSize > length))
+    return false;
+
+  reader->info.nbChannels = data[8];
+  reader->info.samplePeriod = Get32(&data[12]);
+  voltPerBit.l = Get32(&data[16]);
+  memcpy(&reader->info.voltPerBit, &voltPerBit.l, sizeof(voltPerBit.l));
+  reader->info.nbSamples = Get32(&data[20]);
+
+  if ((reader->info.nbChannels == 0) || (reader->info.nbChannels > CAPTURE_MAX_CHANNELS))
+    return false;
+
+  reader->data = data;
+  reader->length = length;
+  reader->offset = headerSize;
+
+  return true;
+}
+
+bool Capture_ReadChunk(TCaptureReader* const reader, int16_t* const samples[], const uint16_t maxSamples, uint16_t* const nbSamples)
+{
+  const uint8_t* chunk = &reader->data[reader->offset];
+  const uint8_t* payload;
+  uint32_t length, position = 0;
+  uint16_t count;
+
+  if (reader->length - reader->offset < CAPTURE_CHUNK_HEADER_SIZE)
+    return false;
+
+  count = Get16(&chunk[0]);
+  length = Get32(&chunk[4]);
+  if ((count > maxSamples) || (length > reader->length - reader->offset - CAPTURE_CHUNK_HEADER_SIZE))
+    return false;
+
+  payload = &chunk[CAPTURE_CHUNK_HEADER_SIZE];
+
+  switch (chunk[2])
+  {
+    case CAPTURE_ENCODING_RAW:
+      if (length != (uint32_t)reader->info.nbChannels * count * 2)
+        return false;
+
+      for (uint8_t channelNb = 0; channelNb < reader->info.nbChannels; channelNb++)
+      {
+        for (uint16_t sampleNb = 0; sampleNb < count; sampleNb++)
+        {
+          samples[channelNb][sampleNb] = (int16_t)Get16(&payload[position]);
+          position += 2;
+        }
+      }
+      break;
+
+    case CAPTURE_ENCODING_DELTA:
+      for (uint8_t channelNb = 0; channelNb < reader->info.nbChannels; channelNb++)
+      {
+        int16_t previous = 0;
+
+        for (uint16_t sampleNb = 0; sampleNb < count; sampleNb++)
+        {
+          int32_t delta;
+          uint8_t used = Varint_GetSigned(&payload[position], (uint16_t)((length - position > 0xFFFF) ? 0xFFFF : (length - position)), &delta);
+
+          if (used == 0)
+            return false;
+
+          previous = (int16_t)(previous + delta);
+          samples[channelNb][sampleNb] = previous;
+          position += used;
+        }
+      }
+
+      if (position != length)
+        return false;
+      break;
+
+    default:
+      return false;
+  }
+
+  reader->offset += CAPTURE_CHUNK_HEADER_SIZE + length;
+  *nbSamples = count;
+
+  return true;
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,142 @@
+/*! @file
+ *
+ *  @brief Routines for the ADC sample capture format.
+ *
+ *  This contains the functions for writing and reading captures of the raw samples, so a field event
+ *  can be recorded and played back through the algorithms later.
+ *
+ *  A capture is a header followed by chunks. All fields are little endian.
+ *
+ *    Header (CAPTURE_HEADER_SIZE bytes)
+ *      0   magic "ACAP"
+ *      4   uint16 version (CAPTURE_VERSION)
+ *      6   uint16 header size
+ *      8   uint8  number of channels
+ *      9   uint8  reserved
+ *      10  uint16 reserved
+ *      12  uint32 sample period in ns
+ *      16  float  ADC counts per volt (VOLT_PER_BIT)
+ *      20  uint32 number of samples per channel, or 0 if the capture was not closed
+ *      24  reserved up to the header size
+ *
+ *    Chunk
+ *      0   uint16 number of samples per channel
+ *      2   uint8  encoding (TCaptureEncoding)
+ *      3   uint8  reserved
+ *      4   uint32 payload length
+ *      8   payload - every channel in turn
+ *
+ *  A delta payload holds each sample as a zig-zag varint of its difference from the previous sample of
+ *  the same channel, starting from 0 in every chunk - the same encoding as the COMMAND_STREAM frames, so
+ *  a streamed window can be stored as a chunk as it is.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+// new types
+#include "types.h"
+
+#define CAPTURE_VERSION           1
+#define CAPTURE_HEADER_SIZE       32
+#define CAPTURE_CHUNK_HEADER_SIZE 8
+
+// Most channels in a capture
+#define CAPTURE_MAX_CHANNELS 8
+
+/*! @brief How a chunk's samples are stored.
+ *
+ */
+typedef enum
+{
+  CAPTURE_ENCODING_RAW,     /*!< int16 per sample. */
+  CAPTURE_ENCODING_DELTA    /*!< Zig-zag varint delta per sample. */
+} TCaptureEncoding;
+
+/*! @brief What a capture holds.
+ *
+ */
+typedef struct
+{
+  uint8_t nbChannels;       /*!< Number of channels */
+  uint32_t samplePeriod;    /*!< Sample period in ns */
+  float voltPerBit;         /*!< ADC counts per volt */
+  uint32_t nbSamples;       /*!< Samples per channel, or 0 if not known */
+} TCaptureInfo;
+
+/*! @brief Position in a capture held in memory.
+ *
+ */
+typedef struct
+{
+  const uint8_t* data;      /*!< The whole capture */
+  uint32_t length;          /*!< Its length in bytes */
+  uint32_t offset;          /*!< Offset of the next chunk */
+  TCaptureInfo info;        /*!< From the header */
+} TCaptureReader;
+
+/*! @brief Gets the largest possible size of a chunk.
+ *
+ *  @param nbChannels The number of channels.
+ *  @param nbSamples The number of samples per channel.
+ *  @return uint32_t - The size in bytes, including the chunk header.
+ */
+uint32_t Capture_ChunkSizeMax(const uint8_t nbChannels, const uint16_t nbSamples);
+
+/*! @brief Writes a capture header.
+ *
+ *  @param buffer Where the header is written - CAPTURE_HEADER_SIZE bytes.
+ *  @param info What the capture holds.
+ *  @return bool - TRUE if info is valid.
+ */
+bool Capture_WriteHeader(uint8_t* const buffer, const TCaptureInfo* const info);
+
+/*! @brief Delta encodes a block of samples.
+ *
+ *  The samples are read where they are, a sample of every channel together, and encoded a channel at a time.
+ *  @param buffer Where the encoding is written - up to nbChannels * nbSamples * VARINT_MAX_BYTES_16 bytes.
+ *  @param samples The first sample of the first channel - sample n of channel c is samples[n * stride + c].
+ *  @param nbChannels The number of channels.
+ *  @param nbSamples The number of samples in each channel.
+ *  @param stride The distance from one sample of a channel to the next, at least nbChannels.
+ *  @return uint32_t - The number of bytes written.
+ */
+uint32_t Capture_EncodeDeltas(uint8_t* const buffer, const int16_t* const samples, const uint8_t nbChannels, const uint16_t nbSamples,
+                              const uint16_t stride);
+
+/*! @brief Writes a chunk.
+ *
+ *  @param buffer Where the chunk is written - Capture_ChunkSizeMax bytes.
+ *  @param samples The first sample of the first channel - sample n of channel c is samples[n * stride + c].
+ *  @param nbChannels The number of channels.
+ *  @param nbSamples The number of samples in each channel.
+ *  @param stride The distance from one sample of a channel to the next, at least nbChannels.
+ *  @param encoding How the samples are stored - a delta chunk that would be larger than raw is stored raw.
+ *  @return uint32_t - The number of bytes written, or 0 if the encoding is invalid.
+ */
+uint32_t Capture_WriteChunk(uint8_t* const buffer, const int16_t* const samples, const uint8_t nbChannels,
+                            const uint16_t nbSamples, const uint16_t stride, const TCaptureEncoding encoding);
+
+/*! @brief Starts reading a capture held in memory.
+ *
+ *  @param reader The reader to set up.
+ *  @param data The capture.
+ *  @param length The length of the capture in bytes.
+ *  @return bool - TRUE if the header is valid.
+ */
+bool Capture_ReaderInit(TCaptureReader* const reader, const uint8_t* const data, const uint32_t length);
+
+/*! @brief Decodes the next chunk.
+ *
+ *  @param reader The reader.
+ *  @param samples Where each channel's samples are written.
+ *  @param maxSamples The room for samples in each channel.
+ *  @param nbSamples A pointer to where the number of samples per channel is written.
+ *  @return bool - TRUE if a chunk was decoded, FALSE at the end of the capture or if a chunk is damaged.
+ */
+bool Capture_ReadChunk(TCaptureReader* const reader, int16_t* const samples[], const uint16_t maxSamples, uint16_t* const nbSamples);
+
+#endif
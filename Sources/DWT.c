@@ -0,0 +1,46 @@
+/*! @file
+ *
+ *  @brief Routines for the Cortex-M4 Data Watchpoint and Trace (DWT) cycle counter.
+ *
+ *  This contains the functions for counting core clock cycles, for timing code on the tower.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup DWT_module DWT module documentation
+**  @{
+*/
+/* MODULE DWT */
+
+#include "DWT.h"
+#include "MK70F12.h"
+
+// Trace enable in the Debug Exception and Monitor Control Register - the DWT does not count without it
+#define DEMCR_TRCENA_MASK 0x01000000u
+
+#define DWT_CTRL_CYCCNTENA_MASK 0x00000001u
+// Set when the DWT has no cycle counter
+#define DWT_CTRL_NOCYCCNT_MASK  0x02000000u
+
+bool DWT_Init(void)
+{
+  DEMCR |= DEMCR_TRCENA_MASK;
+
+  if (DWT_CTRL & DWT_CTRL_NOCYCCNT_MASK)
+    return false;
+
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= DWT_CTRL_CYCCNTENA_MASK;
+
+  return true;
+}
+
+uint32_t DWT_CycleCount(void)
+{
+  return DWT_CYCCNT;
+}
+
+/*!
+** @}
+*/
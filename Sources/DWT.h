@@ -0,0 +1,30 @@
+/*! @file
+ *
+ *  @brief Routines for the Cortex-M4 Data Watchpoint and Trace (DWT) cycle counter.
+ *
+ *  This contains the functions for counting core clock cycles, for timing code on the tower.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef DWT_H
+#define DWT_H
+
+// new types
+#include "types.h"
+
+/*! @brief Starts the cycle counter.
+ *
+ *  Enables the trace block and the DWT cycle counter, from 0.
+ *  @return bool - TRUE if the core has a cycle counter and it is running.
+ */
+bool DWT_Init(void);
+
+/*! @brief Gets the cycle count.
+ *
+ *  @return uint32_t - Core clock cycles since DWT_Init, wrapping every 2^32 cycles (86 s at 50 MHz).
+ */
+uint32_t DWT_CycleCount(void);
+
+#endif
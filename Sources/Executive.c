@@ -0,0 +1,123 @@
+/*! @file
+ *
+ *  @brief Routines to run a cycle of stages within fixed budgets.
+ *
+ *  This contains the functions for a cyclic executive: a table of stages that one thread runs in order
+ *  every cycle, with each stage timed against its budget on the DWT cycle counter.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Executive_module Executive module documentation
+**  @{
+*/
+/* MODULE Executive */
+
+#include "Executive.h"
+#include "DWT.h"
+#include "handle.h"
+
+static const TExecutiveStage* Stages;
+static uint8_t NbStages;
+
+static uint32_t Overruns[EXECUTIVE_MAX_STAGES];
+static uint32_t MaxCycles[EXECUTIVE_MAX_STAGES];
+
+/*! @brief Sends one value in a packet.
+ *
+ *  @return bool - TRUE if the packet was queued.
+ */
+static bool PutValue(const uint8_t request, const uint32_t value)
+{
+  uint16union_t saturated;
+
+  saturated.l = (value > 0xFFFF) ? 0xFFFF : (uint16_t)value;
+  return Packet_Put(COMMAND_EXECUTIVE, request, saturated.s.Lo, saturated.s.Hi);
+}
+
+/*! @brief Handles COMMAND_EXECUTIVE.
+ *
+ *  @param packet A pointer to the received packet.
+ *  @return bool - TRUE if the request was carried out.
+ */
+static bool HandleExecutiveCommand(const TPacket* const packet)
+{
+  uint8_t request = Packet_Parameter1(packet);
+  uint8_t stageNb = request & ~EXECUTIVE_MAX;
+  bool success = true;
+
+  if (request == EXECUTIVE_ALL_STAGES)
+  {
+    for (stageNb = 0; stageNb < NbStages; stageNb++)
+      success &= PutValue(stageNb, Overruns[stageNb]) && PutValue(stageNb | EXECUTIVE_MAX, MaxCycles[stageNb]);
+
+    return success;
+  }
+
+  if (stageNb >= NbStages)
+    return false;
+
+  return PutValue(request, (request & EXECUTIVE_MAX) ? MaxCycles[stageNb] : Overruns[stageNb]);
+}
+
+bool Executive_Init(const TExecutiveStage* const stages, const uint8_t nbStages)
+{
+  if (!stages || (nbStages == 0) || (nbStages > EXECUTIVE_MAX_STAGES))
+    return false;
+
+  Stages = stages;
+  NbStages = nbStages;
+
+  for (uint8_t stageNb = 0; stageNb < NbStages; stageNb++)
+  {
+    Overruns[stageNb] = 0;
+    MaxCycles[stageNb] = 0;
+  }
+
+  return Handle_Register(COMMAND_EXECUTIVE, HandleExecutiveCommand);
+}
+
+bool Executive_Run(void)
+{
+  bool withinBudget = true;
+  uint32_t start = DWT_CycleCount();
+
+  for (uint8_t stageNb = 0; stageNb < NbStages; stageNb++)
+  {
+    uint32_t finish, cycles;
+
+    Stages[stageNb].run();
+
+    // Each stage ends where the next starts, so reading the counter once per stage is enough
+    finish = DWT_CycleCount();
+    cycles = finish - start;
+    start = finish;
+
+    if (cycles > MaxCycles[stageNb])
+      MaxCycles[stageNb] = cycles;
+
+    if (cycles > Stages[stageNb].budget)
+    {
+      Overruns[stageNb]++;
+      withinBudget = false;
+    }
+  }
+
+  return withinBudget;
+}
+
+bool Executive_GetStage(const uint8_t stageNb, uint32_t* const overruns, uint32_t* const max)
+{
+  if (stageNb >= NbStages)
+    return false;
+
+  *overruns = Overruns[stageNb];
+  *max = MaxCycles[stageNb];
+
+  return true;
+}
+
+/*!
+** @}
+*/
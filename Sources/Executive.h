@@ -0,0 +1,63 @@
+/*! @file
+ *
+ *  @brief Routines to run a cycle of stages within fixed budgets.
+ *
+ *  This contains the functions for a cyclic executive: a table of stages that one thread runs in order
+ *  every cycle, with each stage timed against its budget on the DWT cycle counter.
+ *
+ *  COMMAND_EXECUTIVE has a stage number in parameter 1 and replies with the number of times the stage
+ *  has gone over its budget in parameters 2 and 3. With EXECUTIVE_MAX added to the stage number it
+ *  replies with the stage's longest run in cycles instead, and EXECUTIVE_ALL_STAGES gets both for every
+ *  stage. The values saturate at 0xFFFF.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef EXECUTIVE_H
+#define EXECUTIVE_H
+
+// new types
+#include "types.h"
+
+// Most stages in a cycle
+#define EXECUTIVE_MAX_STAGES 8
+
+// Parameter 1 of COMMAND_EXECUTIVE
+#define EXECUTIVE_MAX        0x80
+#define EXECUTIVE_ALL_STAGES 0xFF
+
+/*! @brief A stage of the cycle.
+ *
+ */
+typedef struct
+{
+  void (*run)(void);        /*!< Does the stage's work */
+  uint32_t budget;          /*!< Most cycles it should take */
+} TExecutiveStage;
+
+/*! @brief Sets up the executive before first use.
+ *
+ *  Registers the handler for COMMAND_EXECUTIVE.
+ *  @param stages The stages in the order they run - the table is used in place.
+ *  @param nbStages The number of stages.
+ *  @return bool - TRUE if the executive was successfully initialized.
+ */
+bool Executive_Init(const TExecutiveStage* const stages, const uint8_t nbStages);
+
+/*! @brief Runs one cycle - every stage in turn.
+ *
+ *  @return bool - TRUE if every stage was within its budget.
+ */
+bool Executive_Run(void);
+
+/*! @brief Gets the timing of a stage.
+ *
+ *  @param stageNb The stage.
+ *  @param overruns A pointer to where the number of runs over budget is written.
+ *  @param max A pointer to where the longest run in cycles is written.
+ *  @return bool - TRUE if the stage exists.
+ */
+bool Executive_GetStage(const uint8_t stageNb, uint32_t* const overruns, uint32_t* const max);
+
+#endif
@@ -12,10 +12,61 @@
 
 #define VOLT(x) 3277*(x)
 
+// Most cycles that can be averaged by one estimator
+#define FREQUENCY_MAX_CYCLES 16
+// Distance below zero the signal must reach before the next rising crossing is counted - 0.05 V in
+// whole ADC counts, so each sample is compared in integer arithmetic
+#define FREQUENCY_HYSTERESIS 164
+
+/*! @brief Frequency estimator state, fed one sample at a time.
+ *
+ */
+typedef struct
+{
+  uint32_t sampleRate;                          /*!< Sample rate in Hz */
+  uint8_t nbCycles;                             /*!< Number of cycles averaged */
+  uint8_t nbCrossings;                          /*!< Number of crossing times held, up to nbCycles + 1 */
+  uint8_t newest;                               /*!< Index of the most recent crossing time */
+  bool armed;                                   /*!< TRUE once the signal has gone below -FREQUENCY_HYSTERESIS */
+  int16_t lastSample;                           /*!< The previous sample */
+  uint32_t sampleTime;                          /*!< Time of the previous sample, in 1/65536ths of a sample */
+  uint32_t crossings[FREQUENCY_MAX_CYCLES + 1]; /*!< Times of the most recent rising zero crossings */
+  volatile uint16_t frequency;                  /*!< Published frequency in 0.01 Hz, or 0 if not yet known */
+} TFrequencyEstimator;
+
 bool Frequency_isZeroCrossing (int16_t sample1, int16_t sample2);
 
-void Frequency_interpolatePoint1 (int16_t sample1, int16_t sample2);
+/*! @brief Finds where between two samples the signal crosses zero, by linear interpolation.
+ *
+ *  @param sample1 The sample before the crossing.
+ *  @param sample2 The sample after the crossing.
+ *  @return uint16_t - Fraction of a sample period after sample1, in 1/65536ths.
+ *  @note Assumes Frequency_isZeroCrossing is TRUE for the two samples.
+ */
+uint16_t Frequency_interpolateCrossing (int16_t sample1, int16_t sample2);
 
+/*! @brief Sets up a frequency estimator before first use.
+ *
+ *  @param estimator A pointer to the estimator.
+ *  @param sampleRate The rate samples will be fed at, in Hz.
+ *  @param nbCycles The number of cycles to average over, from 1 to FREQUENCY_MAX_CYCLES.
+ *  @return bool - TRUE if the estimator was set up.
+ */
+bool Frequency_Init (TFrequencyEstimator* const estimator, const uint32_t sampleRate, const uint8_t nbCycles);
+
+/*! @brief Feeds the next sample to a frequency estimator.
+ *
+ *  The estimate is republished at every rising zero crossing, averaged over the last nbCycles cycles.
+ *  @param estimator A pointer to the estimator.
+ *  @param sample The next sample.
+ */
+void Frequency_Update (TFrequencyEstimator* const estimator, const int16_t sample);
 
+/*! @brief Gets the latest published frequency.
+ *
+ *  @param estimator A pointer to the estimator.
+ *  @return uint16_t - The frequency in 0.01 Hz, or 0 if not enough cycles have been seen yet.
+ */
+uint16_t Frequency_Get (const TFrequencyEstimator* const estimator);
 
 #endif /* SOURCES_FREQUENCY_H_ */
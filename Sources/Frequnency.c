@@ -22,9 +22,86 @@ bool Frequency_isZeroCrossing (int16_t sample1, int16_t sample2)
 
 }
 
-void Frequency_interpolatePoint1 (int16_t sample1, int16_t sample2)
+uint16_t Frequency_interpolateCrossing (int16_t sample1, int16_t sample2)
 {
+  int32_t rise = (int32_t)sample2 - sample1;
+  int32_t distance = (int32_t)VOLT(0) - sample1;
 
+  if (rise < 0)
+  {
+    rise = -rise;
+    distance = -distance;
+  }
+
+  if (distance >= rise)
+    return 0xFFFF;
+
+  return (uint16_t)(((uint32_t)distance << 16) / (uint32_t)rise);
+}
+
+bool Frequency_Init (TFrequencyEstimator* const estimator, const uint32_t sampleRate, const uint8_t nbCycles)
+{
+  if ((sampleRate == 0) || (nbCycles == 0) || (nbCycles > FREQUENCY_MAX_CYCLES))
+    return false;
+
+  estimator->sampleRate = sampleRate;
+  estimator->nbCycles = nbCycles;
+  estimator->nbCrossings = 0;
+  estimator->newest = 0;
+  estimator->armed = false;
+  estimator->lastSample = 0;
+  estimator->sampleTime = 0;
+  estimator->frequency = 0;
+
+  return true;
+}
+
+void Frequency_Update (TFrequencyEstimator* const estimator, const int16_t sample)
+{
+  uint32_t crossingTime;
+  uint32_t span;
+  uint8_t oldest;
+
+  estimator->sampleTime += 0x10000;
+
+  if (sample < -FREQUENCY_HYSTERESIS)
+  {
+    estimator->armed = true;
+  }
+  else if (estimator->armed && (estimator->lastSample < VOLT(0)) && (sample >= VOLT(0)))
+  {
+    // Rising crossing - somewhere between the previous sample and this one
+    estimator->armed = false;
+    crossingTime = estimator->sampleTime - 0x10000 + Frequency_interpolateCrossing(estimator->lastSample, sample);
+
+    if (++estimator->newest > FREQUENCY_MAX_CYCLES)
+      estimator->newest = 0;
+    estimator->crossings[estimator->newest] = crossingTime;
+
+    if (estimator->nbCrossings <= estimator->nbCycles)
+      estimator->nbCrossings++;
+
+    if (estimator->nbCrossings > estimator->nbCycles)
+    {
+      // Average over the span of the last nbCycles whole cycles
+      oldest = (estimator->newest >= estimator->nbCycles) ?
+               (estimator->newest - estimator->nbCycles) :
+               (estimator->newest + FREQUENCY_MAX_CYCLES + 1 - estimator->nbCycles);
+      span = crossingTime - estimator->crossings[oldest];
+
+      if (span != 0)
+      {
+        estimator->frequency = (uint16_t)((((uint64_t)estimator->sampleRate * 100 * estimator->nbCycles << 16) + (span / 2)) / span);
+      }
+    }
+  }
+
+  estimator->lastSample = sample;
+}
+
+uint16_t Frequency_Get (const TFrequencyEstimator* const estimator)
+{
+  return estimator->frequency;
 }
 
 
@@ -0,0 +1,181 @@
+/*! @file
+ *
+ *  @brief Routines to sleep the core while there is nothing to do.
+ *
+ *  This contains the idle thread, which waits for an interrupt in Wait mode instead of spinning, and
+ *  counts how often and for how long it slept.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Idle_module Idle module documentation
+**  @{
+*/
+/* MODULE Idle */
+
+#include "Idle.h"
+#include "Acquisition.h"
+#include "Cpu.h"
+#include "OS.h"
+#include "Sleep.h"
+#include "handle.h"
+
+/*!
+ * @struct TIdleCounts
+ * @brief What the idle thread has counted since the last reset.
+ */
+typedef struct
+{
+  uint32_t wakes;                   /*!< Interrupts that ended a sleep */
+  uint32_t sysTickWakes;            /*!< The ones that were the SysTick */
+  uint64_t asleep;                  /*!< Bus clock cycles spent asleep */
+  uint64_t elapsed;                 /*!< Bus clock cycles since the reset, as of the last wake */
+} TIdleCounts;
+
+// Written by the idle thread with interrupts disabled
+static TIdleCounts Counts;
+// Timestamp Counts.elapsed runs up to
+static uint32_t LastCount;
+
+/*! @brief Starts counting again.
+ *
+ */
+static void Reset(void)
+{
+  OS_DisableInterrupts();
+  Counts.wakes = 0;
+  Counts.sysTickWakes = 0;
+  Counts.asleep = 0;
+  Counts.elapsed = 0;
+  LastCount = Acquisition_Time();
+  OS_EnableInterrupts();
+}
+
+/*! @brief Copies the counts.
+ *
+ */
+static void Snapshot(TIdleCounts* const counts)
+{
+  OS_DisableInterrupts();
+  *counts = Counts;
+  OS_EnableInterrupts();
+}
+
+/*! @brief Works out a count per second.
+ *
+ */
+static uint32_t PerSecond(const uint32_t count, const uint64_t elapsed)
+{
+  return elapsed ? (uint32_t)(((uint64_t)count * CPU_BUS_CLK_HZ) / elapsed) : 0;
+}
+
+/*! @brief Works out the time asleep in hundredths of a percent.
+ *
+ */
+static uint16_t Residency(const TIdleCounts* const counts)
+{
+  return counts->elapsed ? (uint16_t)((counts->asleep * IDLE_RESIDENCY_FULL) / counts->elapsed) : 0;
+}
+
+/*! @brief Sends one value in a packet.
+ *
+ *  @return bool - TRUE if the packet was queued.
+ */
+static bool PutValue(const uint8_t request)
+{
+  TIdleCounts counts;
+  uint32_t value;
+  uint16union_t saturated;
+
+  Snapshot(&counts);
+
+  switch (request)
+  {
+    case IDLE_WAKES:
+      value = PerSecond(counts.wakes, counts.elapsed);
+      break;
+    case IDLE_SYSTICK_WAKES:
+      value = PerSecond(counts.sysTickWakes, counts.elapsed);
+      break;
+    case IDLE_RESIDENCY:
+      value = Residency(&counts);
+      break;
+    default:
+      return false;
+  }
+
+  saturated.l = (value > 0xFFFF) ? 0xFFFF : (uint16_t)value;
+  return Packet_Put(COMMAND_IDLE, request, saturated.s.Lo, saturated.s.Hi);
+}
+
+/*! @brief Handles COMMAND_IDLE.
+ *
+ *  @param packet A pointer to the received packet.
+ *  @return bool - TRUE if the request was carried out.
+ */
+static bool HandleIdleCommand(const TPacket* const packet)
+{
+  switch (Packet_Parameter1(packet))
+  {
+    case IDLE_RESET:
+      Reset();
+      return Packet_Put(COMMAND_IDLE, IDLE_RESET, 0, 0);
+    case IDLE_ALL:
+      return PutValue(IDLE_WAKES) && PutValue(IDLE_SYSTICK_WAKES) && PutValue(IDLE_RESIDENCY);
+    default:
+      return PutValue(Packet_Parameter1(packet));
+  }
+}
+
+bool Idle_Init(void)
+{
+  Reset();
+
+  return Sleep_Init()
+      && Handle_Register(COMMAND_IDLE, HandleIdleCommand);
+}
+
+void Idle_Thread(void* pData)
+{
+  for (;;)
+  {
+    uint32_t start, finish;
+    uint8_t vector;
+
+    // The interrupt that wakes the core runs once they are enabled, after the sleep has been timed
+    OS_DisableInterrupts();
+
+    // The DWT cycle counter stops with the core clock in Wait mode, so the sleep is timed on the bus clock
+    start = Acquisition_Time();
+    vector = Sleep_Wait();
+    finish = Acquisition_Time();
+
+    Counts.wakes++;
+    if (vector == SLEEP_VECTOR_SYSTICK)
+      Counts.sysTickWakes++;
+    Counts.asleep += finish - start;
+    // Less than a wrap of the counter goes by between wakes while anything sleeps at all
+    Counts.elapsed += finish - LastCount;
+    LastCount = finish;
+
+    OS_EnableInterrupts();
+  }
+}
+
+bool Idle_Get(uint32_t* const wakes, uint32_t* const sysTickWakes, uint16_t* const residency)
+{
+  TIdleCounts counts;
+
+  Snapshot(&counts);
+
+  *wakes = counts.wakes;
+  *sysTickWakes = counts.sysTickWakes;
+  *residency = Residency(&counts);
+
+  return counts.elapsed > 0;
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,71 @@
+/*! @file
+ *
+ *  @brief Routines to sleep the core while there is nothing to do.
+ *
+ *  This contains the idle thread, which runs at IDLE_THREAD_PRIORITY, just above the RTOS's own idle
+ *  thread, and waits for an interrupt in Wait mode instead of spinning. It sleeps with interrupts
+ *  disabled, so the acquisition's timestamp counter gives how long each sleep lasted before the interrupt
+ *  that ended it runs - the DWT cycle counter would not do, as it stops with the core clock. It is not created through Monitor_ThreadCreate, so its time still counts as idle in
+ *  COMMAND_LOAD.
+ *
+ *  The SysTick cannot be suppressed, as libOS keeps its time in SysTick ticks, but it is only 100 Hz
+ *  against the PIT's 800 Hz, and the SysTick wakes are counted separately to show what it costs.
+ *
+ *  COMMAND_IDLE has parameter 1 as in TIdleRequest and replies with the value in parameters 2 and 3.
+ *  The rates and residency are since start up or the last IDLE_RESET.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef IDLE_H
+#define IDLE_H
+
+// new types
+#include "types.h"
+
+// Above the RTOS's idle thread at OS_LOWEST_PRIORITY
+#define IDLE_THREAD_PRIORITY 30
+
+// Words of stack - only the thread's own frames, as interrupts use the main stack
+#define IDLE_STACK_SIZE 128
+
+// Residency of a core that slept the whole time, i.e. hundredths of a percent
+#define IDLE_RESIDENCY_FULL 10000
+
+/*! @brief Parameter 1 of COMMAND_IDLE.
+ *
+ */
+typedef enum
+{
+  IDLE_WAKES = 0,                   /*!< Wakes per second. */
+  IDLE_SYSTICK_WAKES,               /*!< Wakes per second by the SysTick. */
+  IDLE_RESIDENCY,                   /*!< Time asleep in hundredths of a percent. */
+  IDLE_RESET = 0xFE,                /*!< Start counting again. */
+  IDLE_ALL = 0xFF                   /*!< Every value. */
+} TIdleRequest;
+
+/*! @brief Sets up the idle thread before first use.
+ *
+ *  Registers the handler for COMMAND_IDLE.
+ *  @return bool - TRUE if the idle thread's modules were successfully initialized.
+ */
+bool Idle_Init(void);
+
+/*! @brief Sleeps the core whenever no other thread is ready.
+ *
+ *  @param pData Not used.
+ *  @note Create at IDLE_THREAD_PRIORITY with OS_ThreadCreate.
+ */
+void Idle_Thread(void* pData);
+
+/*! @brief Gets the counts since start up or the last reset.
+ *
+ *  @param wakes A pointer to where the number of wakes is written.
+ *  @param sysTickWakes A pointer to where the number of them that were the SysTick is written.
+ *  @param residency A pointer to where the time asleep, in hundredths of a percent, is written.
+ *  @return bool - TRUE if the idle thread has run since then.
+ */
+bool Idle_Get(uint32_t* const wakes, uint32_t* const sysTickWakes, uint16_t* const residency);
+
+#endif
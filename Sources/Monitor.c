@@ -0,0 +1,478 @@
+/*! @file
+ *
+ *  @brief Routines to monitor the threads' use of the RTOS.
+ *
+ *  This contains the functions for measuring how much of its stack each thread has used, and how much
+ *  of the CPU.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Monitor_module Monitor module documentation
+**  @{
+*/
+/* MODULE Monitor */
+
+#include <stddef.h>
+
+#include "Monitor.h"
+#include "Acquisition.h"
+#include "Cpu.h"
+#include "DWT.h"
+#include "handle.h"
+
+// Unlikely to be a real stack word - not an address in RAM or flash, nor a small number
+#define MONITOR_STACK_PAINT 0xC5C5C5C5u
+
+// In timestamp counts, which run on the bus clock
+#define MONITOR_LOAD_PERIOD ((CPU_BUS_CLK_HZ / 1000) * MONITOR_LOAD_PERIOD_MS)
+
+// Where the idle time is kept in TMonitorLoadSlot.cycles
+#define MONITOR_IDLE MONITOR_MAX_THREADS
+
+#define MONITOR_LATENCY_BUCKET_CYCLES ((CPU_CORE_CLK_HZ / 1000000) * MONITOR_LATENCY_BUCKET_NS / 1000)
+
+// Latency frame - cycles per bucket, number of buckets, the buckets, then min, max, missed, dropped and overruns
+#define MONITOR_LATENCY_FRAME_PAYLOAD (3 + 4 * (MONITOR_LATENCY_BUCKETS + 5))
+
+/*!
+ * @struct TMonitorStack
+ */
+typedef struct
+{
+  uint8_t priority;         /*!< The thread it belongs to */
+  uint16_t size;            /*!< Size in words */
+  const uint32_t* stack;    /*!< Lowest word, the last to be used */
+} TMonitorStack;
+
+/*!
+ * @struct TMonitorLoadSlot
+ * @brief The cycle counts at the start of a load period.
+ */
+typedef struct
+{
+  uint32_t time;                                /*!< Timestamp */
+  uint32_t cycles[MONITOR_MAX_THREADS + 1];     /*!< Bus clock cycles run by each stack, then idle */
+} TMonitorLoadSlot;
+
+static TMonitorStack Stacks[MONITOR_MAX_THREADS];
+static volatile uint8_t NbStacks;
+
+// Bus clock cycles run by each stack, then idle, wrapping
+static uint32_t Cycles[MONITOR_MAX_THREADS + 1];
+static uint32_t LastSwitch;
+
+static TMonitorLoadSlot LoadSlots[MONITOR_LOAD_SLOTS];
+// The slot of the current period, and how many have been filled
+static uint8_t LoadSlot;
+static uint8_t NbLoadSlots;
+
+/*!
+ * @struct TMonitorLatency
+ */
+typedef struct
+{
+  uint32_t buckets[MONITOR_LATENCY_BUCKETS];    /*!< Number of wakeups in each bucket */
+  uint32_t min;                                 /*!< Fastest, in cycles */
+  uint32_t max;                                 /*!< Slowest, in cycles */
+  uint32_t missed;                              /*!< Blocks done with no wakeup before the next */
+  uint32_t dropped;                             /*!< Blocks overwritten before they were taken */
+  uint32_t overruns;                            /*!< Windows overwritten while they were read */
+} TMonitorLatency;
+
+static TMonitorLatency Latency;
+// Time the last block was done, and whether the thread has yet to wake for it
+static volatile uint32_t BlockTime;
+static volatile bool BlockPending;
+
+/*! @brief Finds a monitored stack.
+ *
+ *  @return const TMonitorStack* - The stack, or NULL if the thread is not monitored.
+ */
+static const TMonitorStack* FindStack(const uint8_t priority)
+{
+  for (uint8_t stackNb = 0; stackNb < NbStacks; stackNb++)
+  {
+    if (Stacks[stackNb].priority == priority)
+      return &Stacks[stackNb];
+  }
+
+  return NULL;
+}
+
+/*! @brief Finds the index of a thread in Cycles.
+ *
+ *  @return int - The index, or -1 if the thread is not monitored.
+ */
+static int FindCycles(const uint8_t priority)
+{
+  if (priority == OS_LOWEST_PRIORITY)
+    return MONITOR_IDLE;
+
+  for (uint8_t stackNb = 0; stackNb < NbStacks; stackNb++)
+  {
+    if (Stacks[stackNb].priority == priority)
+      return stackNb;
+  }
+
+  return -1;
+}
+
+/*! @brief Starts a new load period.
+ *
+ */
+static void NextLoadSlot(const uint32_t now)
+{
+  TMonitorLoadSlot* slot;
+
+  LoadSlot = (LoadSlot + 1) % MONITOR_LOAD_SLOTS;
+  if (NbLoadSlots < MONITOR_LOAD_SLOTS)
+    NbLoadSlots++;
+
+  slot = &LoadSlots[LoadSlot];
+  slot->time = now;
+  for (uint8_t index = 0; index <= MONITOR_MAX_THREADS; index++)
+    slot->cycles[index] = Cycles[index];
+}
+
+/*! @brief Sends the stack usage of a thread.
+ *
+ *  @return bool - TRUE if the reply was queued.
+ */
+static bool PutStackUsage(const uint8_t priority)
+{
+  uint16union_t used;
+  uint16_t size;
+
+  if (!Monitor_GetStackUsage(priority, &used.l, &size))
+    return false;
+
+  return Packet_Put(COMMAND_STACK, priority, used.s.Lo, used.s.Hi);
+}
+
+/*! @brief Handles COMMAND_STACK.
+ *
+ *  @param packet A pointer to the received packet.
+ *  @return bool - TRUE if the request was carried out.
+ */
+static bool HandleStackCommand(const TPacket* const packet)
+{
+  bool success = true;
+
+  if (Packet_Parameter1(packet) != MONITOR_ALL_THREADS)
+    return PutStackUsage(Packet_Parameter1(packet));
+
+  for (uint8_t stackNb = 0; stackNb < NbStacks; stackNb++)
+    success &= PutStackUsage(Stacks[stackNb].priority);
+
+  return success;
+}
+
+/*! @brief Sends the load of a thread.
+ *
+ *  @return bool - TRUE if the reply was queued.
+ */
+static bool PutLoad(const uint8_t priority)
+{
+  uint16union_t load;
+
+  if (!Monitor_GetLoad(priority, &load.l))
+    return false;
+
+  return Packet_Put(COMMAND_LOAD, priority, load.s.Lo, load.s.Hi);
+}
+
+/*! @brief Handles COMMAND_LOAD.
+ *
+ *  @param packet A pointer to the received packet.
+ *  @return bool - TRUE if the request was carried out.
+ */
+static bool HandleLoadCommand(const TPacket* const packet)
+{
+  bool success = true;
+
+  if (Packet_Parameter1(packet) != MONITOR_ALL_THREADS)
+    return PutLoad(Packet_Parameter1(packet));
+
+  for (uint8_t stackNb = 0; stackNb < NbStacks; stackNb++)
+    success &= PutLoad(Stacks[stackNb].priority);
+
+  return success && PutLoad(OS_LOWEST_PRIORITY);
+}
+
+/*! @brief Empties the wakeup latency histogram.
+ *
+ */
+static void ResetLatency(void)
+{
+  OS_DisableInterrupts();
+  for (uint8_t bucketNb = 0; bucketNb < MONITOR_LATENCY_BUCKETS; bucketNb++)
+    Latency.buckets[bucketNb] = 0;
+  Latency.min = UINT32_MAX;
+  Latency.max = 0;
+  Latency.missed = 0;
+  Latency.dropped = 0;
+  Latency.overruns = 0;
+  OS_EnableInterrupts();
+}
+
+/*! @brief Sends one latency value in a legacy packet.
+ *
+ *  @return bool - TRUE if the packet was queued.
+ */
+static bool PutLatency(const uint8_t request, const uint32_t value)
+{
+  uint16union_t saturated;
+
+  saturated.l = (value > 0xFFFF) ? 0xFFFF : (uint16_t)value;
+  return Packet_Put(COMMAND_LATENCY, request, saturated.s.Lo, saturated.s.Hi);
+}
+
+/*! @brief Writes a value into a frame payload.
+ *
+ */
+static void PutUInt32(uint8_t* const buffer, const uint32_t value)
+{
+  buffer[0] = (uint8_t)value;
+  buffer[1] = (uint8_t)(value >> 8);
+  buffer[2] = (uint8_t)(value >> 16);
+  buffer[3] = (uint8_t)(value >> 24);
+}
+
+/*! @brief Sends the whole histogram in one frame.
+ *
+ *  @return bool - TRUE if the frame was queued.
+ */
+static bool PutLatencyFrame(void)
+{
+  uint8_t payload[MONITOR_LATENCY_FRAME_PAYLOAD];
+  uint8_t* next = &payload[3];
+
+  payload[0] = (uint8_t)MONITOR_LATENCY_BUCKET_CYCLES;
+  payload[1] = (uint8_t)(MONITOR_LATENCY_BUCKET_CYCLES >> 8);
+  payload[2] = MONITOR_LATENCY_BUCKETS;
+
+  for (uint8_t bucketNb = 0; bucketNb < MONITOR_LATENCY_BUCKETS; bucketNb++, next += 4)
+    PutUInt32(next, Latency.buckets[bucketNb]);
+
+  PutUInt32(next, (Latency.min == UINT32_MAX) ? 0 : Latency.min);
+  PutUInt32(next + 4, Latency.max);
+  PutUInt32(next + 8, Latency.missed);
+  PutUInt32(next + 12, Latency.dropped);
+  PutUInt32(next + 16, Latency.overruns);
+
+  return Packet_PutFrame(COMMAND_LATENCY, payload, sizeof(payload));
+}
+
+/*! @brief Handles COMMAND_LATENCY.
+ *
+ *  @param packet A pointer to the received packet.
+ *  @return bool - TRUE if the request was carried out.
+ */
+static bool HandleLatencyCommand(const TPacket* const packet)
+{
+  uint8_t request = Packet_Parameter1(packet);
+  uint32_t min = (Latency.min == UINT32_MAX) ? 0 : Latency.min;
+  bool success = true;
+
+  if (request < MONITOR_LATENCY_BUCKETS)
+    return PutLatency(request, Latency.buckets[request]);
+
+  switch (request)
+  {
+    case MONITOR_LATENCY_MIN:
+      return PutLatency(request, min);
+
+    case MONITOR_LATENCY_MAX:
+      return PutLatency(request, Latency.max);
+
+    case MONITOR_LATENCY_MISSED:
+      return PutLatency(request, Latency.missed);
+
+    case MONITOR_LATENCY_DROPPED:
+      return PutLatency(request, Latency.dropped);
+
+    case MONITOR_LATENCY_OVERRUNS:
+      return PutLatency(request, Latency.overruns);
+
+    case MONITOR_LATENCY_RESET:
+      ResetLatency();
+      return true;
+
+    case MONITOR_ALL_THREADS:
+      if (Packet_GetProtocol() == PACKET_PROTOCOL_EXTENDED)
+        return PutLatencyFrame();
+
+      for (uint8_t bucketNb = 0; bucketNb < MONITOR_LATENCY_BUCKETS; bucketNb++)
+        success &= PutLatency(bucketNb, Latency.buckets[bucketNb]);
+
+      return success
+          && PutLatency(MONITOR_LATENCY_MIN, min)
+          && PutLatency(MONITOR_LATENCY_MAX, Latency.max)
+          && PutLatency(MONITOR_LATENCY_MISSED, Latency.missed)
+          && PutLatency(MONITOR_LATENCY_DROPPED, Latency.dropped)
+          && PutLatency(MONITOR_LATENCY_OVERRUNS, Latency.overruns);
+
+    default:
+      return false;
+  }
+}
+
+bool Monitor_Init(void)
+{
+  ResetLatency();
+
+  return Handle_Register(COMMAND_STACK, HandleStackCommand)
+      && Handle_Register(COMMAND_LOAD, HandleLoadCommand)
+      && Handle_Register(COMMAND_LATENCY, HandleLatencyCommand);
+}
+
+OS_ERROR Monitor_ThreadCreate(void (*thread)(void* pd), void* pData, uint32_t* const stack, const uint16_t stackSize,
+                              const uint8_t priority)
+{
+  OS_ERROR error;
+
+  // Painted before the RTOS builds the thread's first frame at the top
+  for (uint16_t wordNb = 0; wordNb < stackSize; wordNb++)
+    stack[wordNb] = MONITOR_STACK_PAINT;
+
+  error = OS_ThreadCreate(thread, pData, &stack[stackSize - 1], priority);
+
+  if ((error == OS_NO_ERROR) && (NbStacks < MONITOR_MAX_THREADS) && !FindStack(priority))
+  {
+    Stacks[NbStacks].priority = priority;
+    Stacks[NbStacks].size = stackSize;
+    Stacks[NbStacks].stack = stack;
+    NbStacks++;
+  }
+
+  return error;
+}
+
+bool Monitor_GetStackUsage(const uint8_t priority, uint16_t* const used, uint16_t* const size)
+{
+  const TMonitorStack* monitored = FindStack(priority);
+  uint16_t unused = 0;
+
+  if (!monitored)
+    return false;
+
+  // The stack grows down, so the untouched words are at the bottom
+  while ((unused < monitored->size) && (monitored->stack[unused] == MONITOR_STACK_PAINT))
+    unused++;
+
+  *used = monitored->size - unused;
+  *size = monitored->size;
+
+  return true;
+}
+
+bool Monitor_GetLoad(const uint8_t priority, uint16_t* const load)
+{
+  int index = FindCycles(priority);
+  const TMonitorLoadSlot* oldest;
+  uint32_t cycles, time;
+
+  if (index < 0)
+    return false;
+
+  // Consistent with the context switch, which runs with interrupts masked
+  OS_DisableInterrupts();
+  oldest = &LoadSlots[(NbLoadSlots < MONITOR_LOAD_SLOTS) ? 0 : (LoadSlot + 1) % MONITOR_LOAD_SLOTS];
+  cycles = Cycles[index] - oldest->cycles[index];
+  time = LastSwitch - oldest->time;
+  OS_EnableInterrupts();
+
+  *load = time ? (uint16_t)(((uint64_t)cycles * MONITOR_LOAD_FULL) / time) : 0;
+
+  return true;
+}
+
+void Monitor_LatencyStart(void* arguments)
+{
+  // The thread is still asleep for the previous block - it is late
+  if (BlockPending)
+    Latency.missed++;
+
+  BlockTime = DWT_CycleCount();
+  BlockPending = true;
+}
+
+void Monitor_LatencyEnd(void)
+{
+  uint32_t cycles, bucketNb;
+
+  OS_DisableInterrupts();
+  if (!BlockPending)
+  {
+    OS_EnableInterrupts();
+    return;
+  }
+  cycles = DWT_CycleCount() - BlockTime;
+  BlockPending = false;
+  OS_EnableInterrupts();
+
+  bucketNb = cycles / MONITOR_LATENCY_BUCKET_CYCLES;
+  if (bucketNb >= MONITOR_LATENCY_BUCKETS)
+    bucketNb = MONITOR_LATENCY_BUCKETS - 1;
+
+  Latency.buckets[bucketNb]++;
+  if (cycles < Latency.min)
+    Latency.min = cycles;
+  if (cycles > Latency.max)
+    Latency.max = cycles;
+}
+
+void Monitor_LatencyDropped(const uint32_t nbBlocks)
+{
+  Latency.dropped += nbBlocks;
+}
+
+void Monitor_LatencyOverrun(void)
+{
+  Latency.overruns++;
+}
+
+void Monitor_ContextSwitch(const uint32_t* const stackPointer)
+{
+  // Not the DWT cycle counter, which stops while the idle thread has the core asleep
+  uint32_t now = Acquisition_Time();
+  uint8_t index = MONITOR_IDLE;
+
+  for (uint8_t stackNb = 0; stackNb < NbStacks; stackNb++)
+  {
+    if ((stackPointer >= Stacks[stackNb].stack) && (stackPointer < Stacks[stackNb].stack + Stacks[stackNb].size))
+    {
+      index = stackNb;
+      break;
+    }
+  }
+
+  Cycles[index] += now - LastSwitch;
+  LastSwitch = now;
+
+  if (NbLoadSlots == 0)
+    NextLoadSlot(now);
+  else if (now - LoadSlots[LoadSlot].time >= MONITOR_LOAD_PERIOD)
+    NextLoadSlot(now);
+}
+
+#if defined(__arm__)
+void __attribute__ ((naked)) Monitor_ContextSwitchISR(void)
+{
+  // r0-r3 and r12 were stacked on entry; lr holds EXC_RETURN, which OS_ContextSwitchISR needs
+  __asm volatile
+  (
+    "push {r0, lr}              \n"
+    "mrs  r0, psp               \n"
+    "bl   Monitor_ContextSwitch \n"
+    "pop  {r0, lr}              \n"
+    "b    OS_ContextSwitchISR   \n"
+  );
+}
+#endif
+
+/*!
+** @}
+*/
@@ -0,0 +1,148 @@
+/*! @file
+ *
+ *  @brief Routines to monitor the threads' use of the RTOS.
+ *
+ *  This contains the functions for measuring how much of its stack each thread has used, and how much
+ *  of the CPU. Threads are created through Monitor_ThreadCreate, which fills the stack with a known
+ *  pattern first; the deepest word no longer holding the pattern is the thread's high water mark.
+ *
+ *  The PendSV vector goes to Monitor_ContextSwitchISR, which charges the time since the last switch to the
+ *  thread being switched out - the one whose stack PSP is in - before the RTOS switches. The time is read
+ *  from the acquisition's timestamp counter, on the bus clock, as the DWT cycle counter stops while the
+ *  idle thread has the core asleep.
+ *  Time in threads that were not created through Monitor_ThreadCreate, such as the RTOS's idle thread,
+ *  counts as idle. Interrupts are charged to the thread they interrupted.
+ *
+ *  COMMAND_STACK has a thread's priority in parameter 1, or MONITOR_ALL_THREADS, and gets one reply per
+ *  thread with the priority in parameter 1 and the most words of stack it has used in parameters 2 and 3.
+ *  Host/build/stacks turns the replies into StackSizes.h.
+ *
+ *  COMMAND_LOAD is the same for CPU load, with the idle time as priority OS_LOWEST_PRIORITY, and the
+ *  share of the CPU over the last MONITOR_LOAD_SLOTS load periods in hundredths of a percent.
+ *
+ *  Monitor_LatencyStart, as the acquisition callback from the block-done DMA interrupt, and
+ *  Monitor_LatencyEnd, when Sample_Thread (Executive_Thread in the cyclic executive build) wakes to take
+ *  the block, time the block-done interrupt to thread wakeup latency - once per ACQUISITION_BLOCK_SAMPLES
+ *  samples - into a histogram of MONITOR_LATENCY_BUCKETS buckets, each MONITOR_LATENCY_BUCKET_NS wide,
+ *  the last also holding everything slower. COMMAND_LATENCY reads it,
+ *  with parameter 1 as in TMonitorLatencyRequest. In an extended session MONITOR_ALL_THREADS gets one frame
+ *  of [cycles per bucket (2 bytes), number of buckets, each bucket's count, min, max, missed, dropped, overruns], the counts
+ *  and times little endian uint32_t and the times in DWT cycles; otherwise it gets a packet per value with
+ *  the value, saturating at 0xFFFF, in parameters 2 and 3.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef MONITOR_H
+#define MONITOR_H
+
+// new types
+#include "types.h"
+#include "OS.h"
+
+// Most threads that can be monitored
+#define MONITOR_MAX_THREADS 16
+
+// Parameter 1 asking about every monitored thread
+#define MONITOR_ALL_THREADS 0xFF
+
+// The load is over a sliding window of this many periods of MONITOR_LOAD_PERIOD_MS
+#define MONITOR_LOAD_SLOTS     8
+#define MONITOR_LOAD_PERIOD_MS 125
+// Load of a thread that had the whole CPU, i.e. hundredths of a percent
+#define MONITOR_LOAD_FULL      10000
+
+// Wakeup latency histogram
+#define MONITOR_LATENCY_BUCKETS   16
+#define MONITOR_LATENCY_BUCKET_NS 5000
+
+/*! @brief Parameter 1 of COMMAND_LATENCY, besides a bucket number.
+ *
+ */
+typedef enum
+{
+  MONITOR_LATENCY_MIN = 0x80,       /*!< Fastest wakeup, in DWT cycles. */
+  MONITOR_LATENCY_MAX,              /*!< Slowest wakeup, in DWT cycles. */
+  MONITOR_LATENCY_MISSED,           /*!< Expiries the thread did not wake for before the next one. */
+  MONITOR_LATENCY_DROPPED,          /*!< Blocks of samples overwritten before the thread took them. */
+  MONITOR_LATENCY_OVERRUNS,         /*!< Windows the sampler wrote over while the RMS stage read them. */
+  MONITOR_LATENCY_RESET = 0xFE      /*!< Empty the histogram. */
+} TMonitorLatencyRequest;
+
+/*! @brief Sets up the monitor module before first use.
+ *
+ *  Registers the handlers for COMMAND_STACK, COMMAND_LOAD and COMMAND_LATENCY. Threads can be created
+ *  through Monitor_ThreadCreate before this is called.
+ *  @return bool - TRUE if the monitor module was successfully initialized.
+ */
+bool Monitor_Init(void);
+
+/*! @brief Paints a thread's stack and creates the thread.
+ *
+ *  @param thread A pointer to the thread's code.
+ *  @param pData A pointer to the data passed to the thread.
+ *  @param stack The thread's stack, lowest address first.
+ *  @param stackSize The size of the stack in words.
+ *  @param priority The thread's priority.
+ *  @return OS_ERROR - The result of OS_ThreadCreate.
+ */
+OS_ERROR Monitor_ThreadCreate(void (*thread)(void* pd), void* pData, uint32_t* const stack, const uint16_t stackSize,
+                              const uint8_t priority);
+
+/*! @brief Gets the most stack a thread has used.
+ *
+ *  @param priority The thread's priority.
+ *  @param used A pointer to where the number of words ever used is written.
+ *  @param size A pointer to where the size of the stack in words is written.
+ *  @return bool - TRUE if the thread was created through Monitor_ThreadCreate.
+ */
+bool Monitor_GetStackUsage(const uint8_t priority, uint16_t* const used, uint16_t* const size);
+
+/*! @brief Gets a thread's share of the CPU over the load window.
+ *
+ *  @param priority The thread's priority, or OS_LOWEST_PRIORITY for the idle time.
+ *  @param load A pointer to where the load is written, in hundredths of a percent.
+ *  @return bool - TRUE if the thread was created through Monitor_ThreadCreate.
+ */
+bool Monitor_GetLoad(const uint8_t priority, uint16_t* const load);
+
+/*! @brief Time stamps the acquisition finishing a block of samples.
+ *
+ *  @param arguments Not used - the signature is that of the acquisition callback.
+ *  @note Called from the block-done DMA interrupt, once per block.
+ */
+void Monitor_LatencyStart(void* arguments);
+
+/*! @brief Adds the time since the last block was done to the wakeup latency histogram.
+ *
+ *  @note Called by the thread taking the blocks as soon as it wakes.
+ */
+void Monitor_LatencyEnd(void);
+
+/*! @brief Counts blocks of samples the sampling thread fell too far behind to take.
+ *
+ *  @param nbBlocks The number of blocks, from TAcquisitionBlock.dropped.
+ *  @note Called by the sampling thread when Acquisition_GetBlock says it missed some.
+ */
+void Monitor_LatencyDropped(const uint32_t nbBlocks);
+
+/*! @brief Counts a window the RMS stage had to drop because the sampler came round to it.
+ *
+ *  @note Called when Regulator_Window says the window was overrun.
+ */
+void Monitor_LatencyOverrun(void);
+
+/*! @brief Charges the time since the last context switch to the thread being switched out.
+ *
+ *  @param stackPointer The outgoing thread's stack pointer.
+ *  @note Called from the context switch with interrupts masked.
+ */
+void Monitor_ContextSwitch(const uint32_t* const stackPointer);
+
+/*! @brief The PendSV handler - calls Monitor_ContextSwitch, then carries on into OS_ContextSwitchISR.
+ *
+ */
+void __attribute__ ((naked)) Monitor_ContextSwitchISR(void);
+
+#endif
@@ -22,27 +22,33 @@
 #include "Cpu.h"
 
 
-static uint32_t ModuleClk;
-static void (*CallbackFuncPtr)(void *);
-static void * CallbackArgs;
+// Interrupts of channels 0 to 3 are IRQs 68 to 71, bits 4 to 7 of the third NVIC register
+#define PIT_IRQ_BIT(channelNb) (1 << (4 + (channelNb)))
 
+/*!
+ * @struct TPITChannel
+ */
+typedef struct
+{
+  void (*callback)(void*);          /*!< Called at each expiry, or NULL */
+  void* arguments;                  /*!< For the callback */
+} TPITChannel;
 
+static uint32_t ModuleClk;
+static TPITChannel Channels[PIT_NB_CHANNELS];
 
-OS_ECB* PITSemaphore;
+// Signalled at each expiry of the channel
+OS_ECB* PITSemaphores[PIT_NB_CHANNELS];
 
 
 /*! @brief PIT initialising function
  *
- *  Creates first new timed interrupt
- *  Turns on Green LED
+ *  Turns on the PIT module, with every channel stopped
  *  @return true if it works
  */
-bool PIT_Init(const uint32_t moduleClk, void (*userFunction)(void*), void* userArguments)
+bool PIT_Init(const uint32_t moduleClk)
 {
   ModuleClk = moduleClk;
-  CallbackFuncPtr = userFunction;
-  CallbackArgs = userArguments;
-  PITSemaphore = OS_SemaphoreCreate(0);
 
   //Initializing system clock gate for PIT
   SIM_SCGC6 |= SIM_SCGC6_PIT_MASK;
@@ -51,76 +57,116 @@ bool PIT_Init(const uint32_t moduleClk, void (*userFunction)(void*), void* userA
   //Freezes the timer when debugging
   PIT_MCR = PIT_MCR_FRZ_MASK;
 
-  //Clearing the PIT interrupt flag to stop interrupts when initializing
-  PIT_TFLG0 |= PIT_TFLG_TIF_MASK;
+  return true;
+}
+
+/*! @brief PIT channel initialising function
+ *
+ *  Sets up a channel's callback, semaphore and interrupt
+ *  @return true if it works
+ */
+bool PIT_ChannelInit(const uint8_t channelNb, void (*userFunction)(void*), void* userArguments)
+{
+  if (channelNb >= PIT_NB_CHANNELS)
+    return false;
 
-  //Enables PIT Timer
-  PIT_Enable(true);
+  Channels[channelNb].callback = userFunction;
+  Channels[channelNb].arguments = userArguments;
+  if (!PITSemaphores[channelNb])
+    PITSemaphores[channelNb] = OS_SemaphoreCreate(0);
+
+  //Clearing the PIT interrupt flag to stop interrupts when initializing
+  PIT_TFLG(channelNb) = PIT_TFLG_TIF_MASK;
 
   //Enables Timer Interrupt
-  PIT_TCTRL0 |= PIT_TCTRL_TIE_MASK;
+  PIT_TCTRL(channelNb) |= PIT_TCTRL_TIE_MASK;
 
-  //Initialize NVIC; Vector = 84; IRQ = 68 non-IPR = 2; IRQ mod 32
   EnterCritical();
   //Clear pending interrupts
-  NVICICPR2 = (1 << 4);
-  //Enable Interrupts for PIT module
-  NVICISER2 = (1 << 4);
+  NVICICPR2 = PIT_IRQ_BIT(channelNb);
+  //Enable Interrupts for the channel
+  NVICISER2 = PIT_IRQ_BIT(channelNb);
   ExitCritical();
 
-  return true;
-
+  return PITSemaphores[channelNb] != NULL;
 }
 
 /*! @brief PIT Set new timed interrupt
  *
- *  Creates new timed interrupt
- *  Turns on Green LED
- *  @return true if it works
+ *  Sets a channel's period and starts it
  */
-void PIT_Set(const uint32_t period, const bool restart)
+void PIT_Set(const uint8_t channelNb, const uint32_t period, const bool restart)
 {
   uint32_t denom = 1e9/ModuleClk;
   uint32_t LDVAL = period/denom  - 1;
-  PIT_LDVAL0 = LDVAL;
+
+  if (channelNb >= PIT_NB_CHANNELS)
+    return;
+
+  PIT_LDVAL(channelNb) = LDVAL;
 
   if (restart)
   {
-    PIT_Enable(false);
-    PIT_LDVAL0 = LDVAL;
-    PIT_Enable(true);
+    PIT_Enable(channelNb, false);
+    PIT_LDVAL(channelNb) = LDVAL;
   }
+
+  PIT_Enable(channelNb, true);
 }
 
-void PIT_Enable(const bool enable)
+void PIT_Enable(const uint8_t channelNb, const bool enable)
 {
+  if (channelNb >= PIT_NB_CHANNELS)
+    return;
+
   if (enable)
   {
-    PIT_TCTRL0 |= PIT_TCTRL_TEN_MASK;
+    PIT_TCTRL(channelNb) |= PIT_TCTRL_TEN_MASK;
   }
   else
   {
-    PIT_TCTRL0 &= ~PIT_TCTRL_TEN_MASK;
+    PIT_TCTRL(channelNb) &= ~PIT_TCTRL_TEN_MASK;
   }
 }
 
-
-void __attribute__ ((interrupt)) PIT_ISR(void)
+/*! @brief Handles an expiry of a channel.
+ *
+ */
+static void Expired(const uint8_t channelNb)
 {
   OS_ISREnter();
 
-  PIT_TFLG0 |= PIT_TFLG_TIF_MASK;
+  PIT_TFLG(channelNb) = PIT_TFLG_TIF_MASK;
 
-  OS_SemaphoreSignal(PITSemaphore);
-
-//  if (UserFunctionPtr)
-//    (*UserFunctionPtr)(UserArgumentsPtr);
+  // Before the semaphore, so the callback sees the expiry before any thread does
+  if (Channels[channelNb].callback)
+    (*Channels[channelNb].callback)(Channels[channelNb].arguments);
 
+  OS_SemaphoreSignal(PITSemaphores[channelNb]);
 
   OS_ISRExit();
 }
 
+void __attribute__ ((interrupt)) PIT0_ISR(void)
+{
+  Expired(0);
+}
+
+void __attribute__ ((interrupt)) PIT1_ISR(void)
+{
+  Expired(1);
+}
+
+void __attribute__ ((interrupt)) PIT2_ISR(void)
+{
+  Expired(2);
+}
+
+void __attribute__ ((interrupt)) PIT3_ISR(void)
+{
+  Expired(3);
+}
+
 /*!
  ** @}
  */
-
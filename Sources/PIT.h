@@ -2,7 +2,8 @@
  *
  *  @brief Routines for controlling Periodic Interrupt Timer (PIT) on the TWR-K70F120M.
  *
- *  This contains the functions for operating the periodic interrupt timer (PIT).
+ *  This contains the functions for operating the periodic interrupt timer (PIT). Each of its channels
+ *  has its own period, callback and semaphore, which is signalled every time the channel expires.
  *
  *  @author PMcL
  *  @date 2015-08-22
@@ -14,38 +15,53 @@
 // new types
 #include "types.h"
 
+#define PIT_NB_CHANNELS 4
+
 /*! @brief Sets up the PIT before first use.
  *
  *  Enables the PIT and freezes the timer when debugging.
  *  @param moduleClk The module clock rate in Hz.
- *  @param userFunction is a pointer to a user callback function.
- *  @param userArguments is a pointer to the user arguments to use with the user callback function.
  *  @return bool - TRUE if the PIT was successfully initialized.
  *  @note Assumes that moduleClk has a period which can be expressed as an integral number of nanoseconds.
  */
-bool PIT_Init(const uint32_t moduleClk, void (*userFunction)(void*), void* userArguments);
+bool PIT_Init(const uint32_t moduleClk);
+
+/*! @brief Sets up a channel before first use.
+ *
+ *  Creates the channel's semaphore and enables its interrupt. The channel does not run until PIT_Set.
+ *  @param channelNb The channel.
+ *  @param userFunction is a pointer to a user callback function, or NULL.
+ *  @param userArguments is a pointer to the user arguments to use with the user callback function.
+ *  @return bool - TRUE if the channel was successfully initialized.
+ */
+bool PIT_ChannelInit(const uint8_t channelNb, void (*userFunction)(void*), void* userArguments);
 
-/*! @brief Sets the value of the desired period of the PIT.
+/*! @brief Sets the value of the desired period of a channel.
  *
+ *  @param channelNb The channel.
  *  @param period The desired value of the timer period in nanoseconds.
- *  @param restart TRUE if the PIT is disabled, a new value set, and then enabled.
- *                 FALSE if the PIT will use the new value after a trigger event.
- *  @note The function will enable the timer and interrupts for the PIT.
+ *  @param restart TRUE if the channel is disabled, a new value set, and then enabled.
+ *                 FALSE if the channel will use the new value after a trigger event.
+ *  @note The function will enable the timer and interrupts for the channel.
  */
-void PIT_Set(const uint32_t period, const bool restart);
+void PIT_Set(const uint8_t channelNb, const uint32_t period, const bool restart);
 
-/*! @brief Enables or disables the PIT.
+/*! @brief Enables or disables a channel.
  *
- *  @param enable - TRUE if the PIT is to be enabled, FALSE if the PIT is to be disabled.
+ *  @param channelNb The channel.
+ *  @param enable - TRUE if the channel is to be enabled, FALSE if the channel is to be disabled.
  */
-void PIT_Enable(const bool enable);
+void PIT_Enable(const uint8_t channelNb, const bool enable);
 
-/*! @brief Interrupt service routine for the PIT.
+/*! @brief Interrupt service routines for the PIT channels.
  *
- *  The periodic interrupt timer has timed out.
- *  The user callback function will be called.
- *  @note Assumes the PIT has been initialized.
+ *  The channel's timer has timed out.
+ *  The channel's user callback function will be called, then its semaphore signalled.
+ *  @note Assumes the channel has been initialized.
  */
-void __attribute__ ((interrupt)) PIT_ISR(void);
+void __attribute__ ((interrupt)) PIT0_ISR(void);
+void __attribute__ ((interrupt)) PIT1_ISR(void);
+void __attribute__ ((interrupt)) PIT2_ISR(void);
+void __attribute__ ((interrupt)) PIT3_ISR(void);
 
 #endif
@@ -6,23 +6,112 @@
  */
 
 #include "RMS.h"
-#include <Math.h>
+#include <math.h>
 #include <stdbool.h>
+#include <stddef.h>
 
-int16_t RMS_Calculate (int16_t sampleArray[MAX_SAMPLE_SIZE], int16_t sampleCycleSize)
+// Published windows - the RMS stage fills one while readers use the other
+static TRMSSnapshot Snapshots[2];
+// Number of the window being written, and of the last window completely written
+static volatile uint32_t WriteSequence;
+static volatile uint32_t Sequence;
+
+void RMS_CalculateAll(const int16_t samples[][RMS_NB_CHANNELS], const int16_t sampleCycleSize, int16_t rms[RMS_NB_CHANNELS])
+{
+  // One sum per channel, kept in registers - RMS_NB_CHANNELS is 3
+  float rmsSum0 = 0;
+  float rmsSum1 = 0;
+  float rmsSum2 = 0;
+
+  // Each sample is read once, in the order it was stored
+  for (int Count = 0; Count < sampleCycleSize; Count++)
+  {
+    rmsSum0 += (samples[Count][0]*samples[Count][0]);
+    rmsSum1 += (samples[Count][1]*samples[Count][1]);
+    rmsSum2 += (samples[Count][2]*samples[Count][2]);
+  }
+
+  // Single precision, which the M4's FPU does - sqrt would go through double in software
+  rms[0] = (int16_t)sqrtf(rmsSum0 / sampleCycleSize);
+  rms[1] = (int16_t)sqrtf(rmsSum1 / sampleCycleSize);
+  rms[2] = (int16_t)sqrtf(rmsSum2 / sampleCycleSize);
+}
+
+void RMS_Publish(const int16_t rms[RMS_NB_CHANNELS])
 {
-  float rmsSum;
-  float rmsAverage;
-  float rmsRoot;
+  uint32_t next = WriteSequence + 1;
+  TRMSSnapshot* snapshot = &Snapshots[next & 1];
 
-  for (int Count =0; Count < sampleCycleSize; Count++)
+  // Claim the buffer readers are not using before touching it
+  WriteSequence = next;
+  __sync_synchronize();
+
+  for (int channelNb = 0; channelNb < RMS_NB_CHANNELS; channelNb++)
   {
-    rmsSum += (sampleArray[Count]*sampleArray[Count]);
+    snapshot->rms[channelNb] = rms[channelNb];
   }
 
-  rmsAverage = rmsSum / sampleCycleSize;
-  rmsRoot = sqrt(rmsAverage);
+  __sync_synchronize();
+  Sequence = next;
+}
+
+/*! @brief Starts a read of the current window.
+ *
+ *  @param sequence A pointer to where the number of the window is stored, for ReadEnd.
+ *  @return const TRMSSnapshot* - The published window, or NULL if there is none yet.
+ */
+static inline const TRMSSnapshot* ReadBegin(uint32_t* const sequence)
+{
+  *sequence = Sequence;
+  __sync_synchronize();
+
+  return (*sequence == 0) ? NULL : &Snapshots[*sequence & 1];
+}
+
+/*! @brief Checks that a read was not overlapped by a write to the same buffer.
+ *
+ *  @param sequence The number of the window returned by ReadBegin.
+ *  @return bool - TRUE if the values read are consistent.
+ */
+static inline bool ReadEnd(const uint32_t sequence)
+{
+  __sync_synchronize();
+  // The buffer is only rewritten two publishes later
+  return (uint32_t)(WriteSequence - sequence) < 2;
+}
+
+bool RMS_Get(const uint8_t channelNb, int16_t* const valuePtr)
+{
+  const TRMSSnapshot* snapshot;
+  uint32_t sequence;
+
+  if (channelNb >= RMS_NB_CHANNELS)
+    return false;
+
+  do
+  {
+    snapshot = ReadBegin(&sequence);
+    if (!snapshot)
+      return false;
+    *valuePtr = snapshot->rms[channelNb];
+  } while (!ReadEnd(sequence));
+
+  return true;
+}
+
+bool RMS_GetSnapshot(TRMSSnapshot* const snapshot)
+{
+  const TRMSSnapshot* published;
+  uint32_t sequence;
+
+  do
+  {
+    published = ReadBegin(&sequence);
+    if (!published)
+      return false;
+    *snapshot = *published;
+  } while (!ReadEnd(sequence));
 
-  return (int16_t)rmsRoot;
+  return true;
 }
 
@@ -11,7 +11,45 @@
 #include "types.h"
 
 #define MAX_SAMPLE_SIZE 16
+#define RMS_NB_CHANNELS 3
 
-int16_t RMS_Calculate (int16_t sampleArray[MAX_SAMPLE_SIZE], int16_t sampleCycleSize);
+/*! @brief The RMS value of every channel over one window.
+ *
+ */
+typedef struct
+{
+  int16_t rms[RMS_NB_CHANNELS];
+} TRMSSnapshot;
+
+/*! @brief Works out the RMS of every channel of a window in one pass.
+ *
+ *  @param samples The window, with a sample of every channel together.
+ *  @param sampleCycleSize The number of samples of each channel.
+ *  @param rms Where the RMS of every channel is written.
+ */
+void RMS_CalculateAll(const int16_t samples[][RMS_NB_CHANNELS], const int16_t sampleCycleSize, int16_t rms[RMS_NB_CHANNELS]);
+
+/*! @brief Publishes the RMS values of a completed window.
+ *
+ *  @param rms The RMS value of every channel.
+ *  @note Must only be called by one thread - the RMS stage.
+ */
+void RMS_Publish(const int16_t rms[RMS_NB_CHANNELS]);
+
+/*! @brief Gets the most recently published RMS value of a channel.
+ *
+ *  Never blocks the publisher and never triggers a recalculation.
+ *  @param channelNb The channel to read.
+ *  @param valuePtr A pointer to where the RMS value is written.
+ *  @return bool - TRUE if the channel is valid and a window has been published.
+ */
+bool RMS_Get(const uint8_t channelNb, int16_t* const valuePtr);
+
+/*! @brief Gets the most recently published RMS values of every channel, all from the same window.
+ *
+ *  @param snapshot A pointer to where the values are copied.
+ *  @return bool - TRUE if a window has been published.
+ */
+bool RMS_GetSnapshot(TRMSSnapshot* const snapshot);
 
 #endif /* SOURCES_RMS_H_ */
@@ -0,0 +1,162 @@
+/*! @file
+ *
+ *  @brief Routines for the voltage regulation pipeline.
+ *
+ *  This contains the sampling, RMS, alarm timing and output stages as step functions with no OS calls,
+ *  so the threads in main.c and the host simulator run exactly the same logic.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Regulator_module Regulator module documentation
+**  @{
+*/
+/* MODULE Regulator */
+
+#include "Regulator.h"
+#include "VRR.h"
+
+#define VOLT(x) ((int16_t)(3276.7*(x)))
+
+// Nominal voltage and the limits either side of it
+#define REGULATOR_NOMINAL     VOLT(2.5)
+#define REGULATOR_LOW_LIMIT   VOLT(2)
+// Deviation at which the inverse timer takes REGULATOR_DELAY_NS - the distance to the limits
+#define REGULATOR_INVERSE_REFERENCE VOLT(0.5)
+
+// Level of an output that is on
+#define REGULATOR_OUTPUT_ON   VOLT(5)
+
+bool Regulator_Init(TRegulator* const regulator, const uint32_t timingPeriod)
+{
+  if (timingPeriod == 0)
+    return false;
+
+  regulator->delay = (uint32_t)(REGULATOR_DELAY_NS / timingPeriod) * REGULATOR_INVERSE_REFERENCE;
+  regulator->mode = DEFINITE;
+  regulator->sampleCount = 0;
+  regulator->filling = 0;
+  regulator->complete = 1;
+  regulator->nbWindows = 0;
+  regulator->nbRaises = 0;
+  regulator->nbLowers = 0;
+  regulator->status = 0;
+
+  for (uint8_t channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+  {
+    regulator->rms[channelNb] = REGULATOR_NOMINAL;
+    regulator->deviation[channelNb] = 0;
+    regulator->progress[channelNb] = 0;
+  }
+
+  return true;
+}
+
+bool Regulator_Sample(TRegulator* const regulator, const int16_t samples[REGULATOR_NB_CHANNELS])
+{
+  int16_t* const slot = regulator->windows[regulator->filling][regulator->sampleCount];
+
+  for (uint8_t channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+    slot[channelNb] = samples[channelNb];
+
+  if (++regulator->sampleCount < MAX_SAMPLE_SIZE)
+    return false;
+
+  // Publish the full window in one store, then fill the other one
+  regulator->complete = regulator->filling;
+  regulator->nbWindows++;
+  regulator->filling ^= 1;
+  regulator->sampleCount = 0;
+  return true;
+}
+
+bool Regulator_Window(TRegulator* const regulator, const TimerType mode)
+{
+  // Counted before the window is looked up, so a window completing in between counts as an overrun
+  const uint32_t windowNb = regulator->nbWindows;
+  int16_t rms[REGULATOR_NB_CHANNELS];
+  uint16_t alarms = 0, settled = 0;
+
+  RMS_CalculateAll(regulator->windows[regulator->complete], MAX_SAMPLE_SIZE, rms);
+
+  // The sampler has moved on into the window that was read, so it may be part of the next one
+  if (regulator->nbWindows != windowNb)
+    return false;
+
+  regulator->mode = mode;
+
+  for (uint8_t channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+    regulator->rms[channelNb] = rms[channelNb];
+
+  for (uint8_t channelNb = 0; channelNb < REGULATOR_NB_CHANNELS; channelNb++)
+  {
+    regulator->deviation[channelNb] = VRR_CalcDeviation(regulator->rms[channelNb]);
+
+    if (VRR_CheckLimits(regulator->rms[channelNb]))
+    {
+      alarms |= REGULATOR_STATUS_BIT(REGULATOR_STATUS_ALARM, channelNb);
+    }
+    else
+    {
+      // Back within the limits - the tap changer has done its job, or the disturbance has gone
+      settled |= REGULATOR_STATUS_BIT(REGULATOR_STATUS_ALARM, channelNb) | REGULATOR_STATUS_BIT(REGULATOR_STATUS_RAISE, channelNb)
+               | REGULATOR_STATUS_BIT(REGULATOR_STATUS_LOWER, channelNb);
+      regulator->progress[channelNb] = 0;
+    }
+  }
+
+  // The alarm stage sets raise and lower bits from other threads, so the word is only changed atomically,
+  // and a channel still in alarm never has its bit cleared in between - most windows change nothing
+  if ((regulator->status & alarms) != alarms)
+    (void)__atomic_fetch_or(&regulator->status, alarms, __ATOMIC_RELAXED);
+  if (regulator->status & settled)
+    (void)__atomic_fetch_and(&regulator->status, (uint16_t)~settled, __ATOMIC_RELAXED);
+
+  return true;
+}
+
+bool Regulator_Timing(TRegulator* const regulator, const uint8_t channelNb)
+{
+  const int16_t deviation = regulator->deviation[channelNb];
+
+  if (!(regulator->status & REGULATOR_STATUS_BIT(REGULATOR_STATUS_ALARM, channelNb)))
+    return false;
+
+  // Definite time counts every period the same; inverse time counts larger deviations faster
+  if (regulator->mode == INVERSE)
+    regulator->progress[channelNb] += (deviation > 0) ? (uint16_t)deviation : 1;
+  else
+    regulator->progress[channelNb] += REGULATOR_INVERSE_REFERENCE;
+
+  if (regulator->progress[channelNb] < regulator->delay)
+    return false;
+
+  regulator->progress[channelNb] = 0;
+  // Each channel times on its own thread, so the shared counts are only changed atomically, like the status word
+  if (regulator->rms[channelNb] < REGULATOR_LOW_LIMIT)
+  {
+    (void)__atomic_fetch_or(&regulator->status, REGULATOR_STATUS_BIT(REGULATOR_STATUS_RAISE, channelNb), __ATOMIC_RELAXED);
+    (void)__atomic_fetch_add(&regulator->nbRaises, 1, __ATOMIC_RELAXED);
+  }
+  else
+  {
+    (void)__atomic_fetch_or(&regulator->status, REGULATOR_STATUS_BIT(REGULATOR_STATUS_LOWER, channelNb), __ATOMIC_RELAXED);
+    (void)__atomic_fetch_add(&regulator->nbLowers, 1, __ATOMIC_RELAXED);
+  }
+
+  return true;
+}
+
+void Regulator_Outputs(const TRegulator* const regulator, int16_t outputs[REGULATOR_NB_OUTPUTS])
+{
+  const uint16_t status = regulator->status;
+
+  outputs[REGULATOR_OUTPUT_RAISE] = (status & REGULATOR_STATUS_FIELD(REGULATOR_STATUS_RAISE)) ? REGULATOR_OUTPUT_ON : 0;
+  outputs[REGULATOR_OUTPUT_LOWER] = (status & REGULATOR_STATUS_FIELD(REGULATOR_STATUS_LOWER)) ? REGULATOR_OUTPUT_ON : 0;
+  outputs[REGULATOR_OUTPUT_ALARM] = (status & REGULATOR_STATUS_FIELD(REGULATOR_STATUS_ALARM)) ? REGULATOR_OUTPUT_ON : 0;
+}
+
+/*!
+** @}
+*/
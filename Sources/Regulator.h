@@ -0,0 +1,124 @@
+/*! @file
+ *
+ *  @brief Routines for the voltage regulation pipeline.
+ *
+ *  This contains the sampling, RMS, alarm timing and output stages as step functions with no OS calls,
+ *  so the threads in main.c and the host simulator run exactly the same logic.
+ *
+ *  A channel outside the limits starts a timer, advanced once per timing period. In definite mode it
+ *  expires after REGULATOR_DELAY_NS; in inverse mode it advances in proportion to the deviation, so it
+ *  expires after REGULATOR_DELAY_NS * REGULATOR_INVERSE_REFERENCE / deviation. On expiry a raise or lower
+ *  is asked for and the timer starts again in case one tap change is not enough.
+ *
+ *  Windows are double buffered: samples go into one buffer while the other holds the last complete
+ *  window, and the two swap as a window completes. So Regulator_Window and anything else reading the
+ *  complete window see a whole, consistent window without locking or copying, as long as they are
+ *  done with it before the next window completes. Each window completed is counted in nbWindows, so
+ *  Regulator_Window can tell when the sampler has come round to the window it was reading and drop it.
+ *
+ *  The state is laid out as arrays indexed by channel rather than a structure per channel, so each stage
+ *  works on all channels in one pass over contiguous memory: the windows hold a sample of every channel
+ *  together, as the acquisition delivers them, and the alarm, raise and lower flags share one word.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef REGULATOR_H
+#define REGULATOR_H
+
+// new types
+#include "types.h"
+#include "RMS.h"
+
+#define REGULATOR_NB_CHANNELS RMS_NB_CHANNELS
+
+// Analog outputs driven by the regulator
+#define REGULATOR_OUTPUT_RAISE 0
+#define REGULATOR_OUTPUT_LOWER 1
+#define REGULATOR_OUTPUT_ALARM 2
+#define REGULATOR_NB_OUTPUTS   3
+
+// Time out of range before a tap change in definite mode, or at the reference deviation in inverse mode
+#define REGULATOR_DELAY_NS 5000000000ULL
+
+/*! @brief Alarm timing characteristic.
+ *
+ */
+typedef enum
+{
+  DEFINITE,
+  INVERSE
+} TimerType;
+
+// Fields of TRegulator.status, each with a bit per channel
+#define REGULATOR_STATUS_ALARM 0      /*!< Set while the channel's rms is outside the limits */
+#define REGULATOR_STATUS_RAISE 4      /*!< Set from a raise until rms is back within the limits */
+#define REGULATOR_STATUS_LOWER 8      /*!< Set from a lower until rms is back within the limits */
+
+// A channel's bit of a status field, and every channel's bits of it
+#define REGULATOR_STATUS_BIT(field, channelNb) ((uint16_t)(1 << ((field) + (channelNb))))
+#define REGULATOR_STATUS_FIELD(field) ((uint16_t)(((1 << REGULATOR_NB_CHANNELS) - 1) << (field)))
+
+/*! @brief State of the regulation pipeline.
+ *
+ */
+typedef struct
+{
+  uint32_t delay;                                           /*!< Timer value at which a tap change is asked for */
+  TimerType mode;                                           /*!< Timing used for the current window */
+  uint8_t sampleCount;                                      /*!< Samples taken in the window being filled */
+  uint8_t filling;                                          /*!< The window being filled */
+  volatile uint8_t complete;                                /*!< The last complete window */
+  volatile uint32_t nbWindows;                              /*!< Windows completed since Regulator_Init */
+  uint16_t nbRaises;                                        /*!< Raises asked for, from 0 or a count the caller kept */
+  uint16_t nbLowers;                                        /*!< Lowers asked for, from 0 or a count the caller kept */
+  int16_t windows[2][MAX_SAMPLE_SIZE][REGULATOR_NB_CHANNELS]; /*!< The window being filled and the last complete one */
+  int16_t rms[REGULATOR_NB_CHANNELS];                       /*!< RMS of the last window */
+  int16_t deviation[REGULATOR_NB_CHANNELS];                 /*!< Distance of rms from the nominal voltage */
+  uint32_t progress[REGULATOR_NB_CHANNELS];                 /*!< Alarm timers, in timing periods weighted by deviation */
+  volatile uint16_t status;                                 /*!< Alarm, raise and lower flags - see REGULATOR_STATUS_* */
+} TRegulator;
+
+/*! @brief Sets up the regulator before first use.
+ *
+ *  @param regulator A pointer to the regulator state.
+ *  @param timingPeriod The period Regulator_Timing is called at in ns.
+ *  @return bool - TRUE if the regulator was successfully initialized.
+ */
+bool Regulator_Init(TRegulator* const regulator, const uint32_t timingPeriod);
+
+/*! @brief Sampling stage - adds one sample of every channel to the window.
+ *
+ *  @param regulator A pointer to the regulator state.
+ *  @param samples One sample of every channel.
+ *  @return bool - TRUE if the window is now complete and Regulator_Window should run.
+ */
+bool Regulator_Sample(TRegulator* const regulator, const int16_t samples[REGULATOR_NB_CHANNELS]);
+
+/*! @brief RMS stage - works out the RMS and alarm state of every channel from the completed window.
+ *
+ *  @param regulator A pointer to the regulator state.
+ *  @param mode The timing to use until the next window.
+ *  @return bool - TRUE if the window was used, FALSE if another window completed while it was being read,
+ *  so the sampler may have written over it, and the RMS and alarm state were left as they were.
+ */
+bool Regulator_Window(TRegulator* const regulator, const TimerType mode);
+
+/*! @brief Alarm stage - advances one channel's alarm timer by one timing period.
+ *
+ *  @param regulator A pointer to the regulator state.
+ *  @param channelNb The channel.
+ *  @return bool - TRUE if the timer expired and a raise or lower was asked for.
+ */
+bool Regulator_Timing(TRegulator* const regulator, const uint8_t channelNb);
+
+/*! @brief Output stage - gets the levels for the raise, lower and alarm outputs.
+ *
+ *  Each output is high if it is high for any channel.
+ *  @param regulator A pointer to the regulator state.
+ *  @param outputs Where the level of each output is written, indexed by REGULATOR_OUTPUT_*.
+ */
+void Regulator_Outputs(const TRegulator* const regulator, int16_t outputs[REGULATOR_NB_OUTPUTS]);
+
+#endif
@@ -0,0 +1,40 @@
+/*! @file
+ *
+ *  @brief Routines for putting the Cortex-M4 core to sleep.
+ *
+ *  This contains the functions for waiting for an interrupt in the K70's Wait mode, where the core
+ *  clock stops but the bus clock, and so the PIT and UARTs, keep running.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Sleep_module Sleep module documentation
+**  @{
+*/
+/* MODULE Sleep */
+
+#include "Sleep.h"
+#include "MK70F12.h"
+
+bool Sleep_Init(void)
+{
+  // Stop mode would stop the bus clock, and with it the PIT that wakes us
+  SCB_SCR &= ~(SCB_SCR_SLEEPDEEP_MASK | SCB_SCR_SLEEPONEXIT_MASK);
+
+  return true;
+}
+
+uint8_t Sleep_Wait(void)
+{
+  // A pending interrupt wakes the core even with PRIMASK set
+  __asm volatile ("dsb\n\t"
+                  "wfi\n\t"
+                  "isb" ::: "memory");
+
+  return (uint8_t)((SCB_ICSR & SCB_ICSR_VECTPENDING_MASK) >> SCB_ICSR_VECTPENDING_SHIFT);
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,36 @@
+/*! @file
+ *
+ *  @brief Routines for putting the Cortex-M4 core to sleep.
+ *
+ *  This contains the functions for waiting for an interrupt in the K70's Wait mode, where the core
+ *  clock stops but the bus clock, and so the PIT and UARTs, keep running.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef SLEEP_H
+#define SLEEP_H
+
+// new types
+#include "types.h"
+
+// Exception number of the SysTick, as returned by Sleep_Wait
+#define SLEEP_VECTOR_SYSTICK 15
+
+/*! @brief Sets up sleeping before first use.
+ *
+ *  Selects Wait mode rather than Stop for WFI, and sleeping only when asked.
+ *  @return bool - TRUE if sleeping was successfully set up.
+ */
+bool Sleep_Init(void);
+
+/*! @brief Sleeps until an interrupt is pending.
+ *
+ *  @return uint8_t - The exception number of the interrupt that woke the core, or 0 if it was unknown.
+ *  @note Must be called with interrupts disabled, so the interrupt is still pending on return and only
+ *        runs once they are enabled again.
+ */
+uint8_t Sleep_Wait(void);
+
+#endif
@@ -0,0 +1,24 @@
+/*! @file
+ *
+ *  @brief Thread stack sizes.
+ *
+ *  Sizes in words. Regenerate with Host/build/stacks from the high water marks of a tower that has run
+ *  every feature for a while.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef STACK_SIZES_H
+#define STACK_SIZES_H
+
+// Not measured yet - big enough for stacking of interrupts and OS use
+#define INIT_MODULES_STACK_SIZE  300
+#define SAMPLE_STACK_SIZE        300
+#define RMS_STACK_SIZE           300
+#define ALARM_STACK_SIZE         300
+#define SIGNAL_OUTPUT_STACK_SIZE 300
+#define HANDLE_PACKET_STACK_SIZE 300
+#define HOUSEKEEPING_STACK_SIZE  300
+
+#endif
@@ -0,0 +1,155 @@
+/*! @file
+ *
+ *  @brief Routines to stream the raw samples to the PC.
+ *
+ *  This contains the functions for sending every sample window as one compressed extended frame.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Stream_module Stream module documentation
+**  @{
+*/
+/* MODULE Stream */
+
+#include "Stream.h"
+#include "Capture.h"
+#include "Varint.h"
+#include "UART.h"
+#include "handle.h"
+#include "OS.h"
+
+// Number of frames that can be on the link at once - one being sent while the next window is encoded
+#define NB_STREAM_BUFFERS 2
+
+/*!
+ * @struct TStreamBuffer
+ */
+typedef struct
+{
+  volatile bool busy;                               /*!< TRUE until the UART DMA has sent the frame */
+  uint8_t bytes[PACKET_FRAME_MAX_SIZE];             /*!< The frame, built in place behind the header */
+} TStreamBuffer;
+
+static TStreamBuffer Buffers[NB_STREAM_BUFFERS];
+static uint8_t NextBuffer;
+
+static volatile bool Streaming;
+static uint16_t Sequence;
+static volatile uint16_t Dropped;
+
+/*! @brief Counts a window that could not be sent.
+ *
+ */
+static void Drop(void)
+{
+  if (Dropped < 0xFFFF)
+    Dropped++;
+
+  // Still advance so the PC sees the gap
+  Sequence++;
+}
+
+/*! @brief Handles COMMAND_STREAM.
+ *
+ *  @param packet A pointer to the received packet.
+ *  @return bool - TRUE if the request was carried out.
+ */
+static bool HandleStreamCommand(const TPacket* const packet)
+{
+  uint16union_t dropped;
+
+  switch (Packet_Parameter1(packet))
+  {
+    case STREAM_STOP:
+      Streaming = false;
+      return true;
+
+    case STREAM_START:
+      // Stream frames only exist in the extended framing
+      if (Packet_GetProtocol() != PACKET_PROTOCOL_EXTENDED)
+        return false;
+
+      // Stream_Window counts both from the sampling thread, which can preempt this one
+      OS_DisableInterrupts();
+      Sequence = 0;
+      Dropped = 0;
+      Streaming = true;
+      OS_EnableInterrupts();
+      return true;
+
+    case STREAM_STATUS:
+      dropped.l = Dropped;
+      return Packet_Put(COMMAND_STREAM, STREAM_STATUS, dropped.s.Lo, dropped.s.Hi);
+
+    default:
+      return false;
+  }
+}
+
+bool Stream_Init(void)
+{
+  Streaming = false;
+  NextBuffer = 0;
+
+  return Handle_Register(COMMAND_STREAM, HandleStreamCommand);
+}
+
+bool Stream_Window(const int16_t* const samples, const uint8_t nbChannels, const uint8_t nbSamples, const uint8_t stride)
+{
+  TStreamBuffer* buffer;
+  uint8_t* payload;
+  uint16_t length;
+  uint16_t size;
+
+  if (!Streaming)
+    return true;
+
+  // A legacy tool has taken over the link
+  if (Packet_GetProtocol() != PACKET_PROTOCOL_EXTENDED)
+  {
+    Streaming = false;
+    return true;
+  }
+
+  // Worst case every delta needs the longest encoding
+  if (STREAM_PAYLOAD_HEADER_SIZE + (uint16_t)nbChannels * nbSamples * VARINT_MAX_BYTES_16 > PACKET_FRAME_MAX_PAYLOAD)
+    return false;
+
+  buffer = &Buffers[NextBuffer];
+  if (buffer->busy)
+  {
+    Drop();
+    return false;
+  }
+
+  payload = &buffer->bytes[PACKET_FRAME_HEADER_SIZE];
+  payload[0] = (uint8_t)Sequence;
+  payload[1] = (uint8_t)(Sequence >> 8);
+  payload[2] = nbChannels;
+  payload[3] = nbSamples;
+  length = STREAM_PAYLOAD_HEADER_SIZE + Capture_EncodeDeltas(&payload[STREAM_PAYLOAD_HEADER_SIZE], samples, nbChannels, nbSamples,
+                                                              stride);
+
+  size = Packet_FrameSeal(buffer->bytes, COMMAND_STREAM, length);
+  if (!UART_OutBuffer(buffer->bytes, size, &buffer->busy))
+  {
+    Drop();
+    return false;
+  }
+
+  Sequence++;
+  NextBuffer = (NextBuffer + 1) % NB_STREAM_BUFFERS;
+
+  return true;
+}
+
+uint16_t Stream_GetDropped(void)
+{
+  return Dropped;
+}
+
+/*!
+** @}
+*/
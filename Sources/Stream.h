@@ -0,0 +1,62 @@
+/*! @file
+ *
+ *  @brief Routines to stream the raw samples to the PC.
+ *
+ *  This contains the functions for sending every sample window as one compressed extended frame.
+ *
+ *  Each COMMAND_STREAM frame carries a 16-bit sequence number, the number of channels and the number of
+ *  samples per channel, followed by each channel in turn as zig-zag varint deltas - the first sample of a
+ *  channel is a delta from 0, so every frame decodes on its own.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+// new types
+#include "types.h"
+#include "packet.h"
+
+// Bytes before the channel data in a stream frame's payload
+#define STREAM_PAYLOAD_HEADER_SIZE 4
+
+/*! @brief Parameter 1 of COMMAND_STREAM.
+ *
+ */
+typedef enum
+{
+  STREAM_STOP,      /*!< Stop streaming. */
+  STREAM_START,     /*!< Start streaming - needs an extended session. */
+  STREAM_STATUS     /*!< Reply with the number of dropped windows in parameters 2 and 3. */
+} TStreamRequest;
+
+/*! @brief Sets up the stream module before first use.
+ *
+ *  Registers the handler for COMMAND_STREAM, with streaming stopped.
+ *  @return bool - TRUE if the stream module was successfully initialized.
+ */
+bool Stream_Init(void);
+
+/*! @brief Sends a completed sample window if streaming.
+ *
+ *  The samples are encoded straight into a frame buffer that the UART sends by DMA. If the link has not
+ *  finished with the previous window's buffer, this window is dropped and counted.
+ *  @param samples The first sample of the first channel - sample n of channel c is samples[n * stride + c].
+ *  Only read during the call.
+ *  @param nbChannels The number of channels.
+ *  @param nbSamples The number of samples in each channel.
+ *  @param stride The distance from one sample of a channel to the next, at least nbChannels.
+ *  @return bool - TRUE if the window was sent, or streaming is stopped.
+ *  @note Call from the sampling thread before the window starts to be overwritten.
+ */
+bool Stream_Window(const int16_t* const samples, const uint8_t nbChannels, const uint8_t nbSamples, const uint8_t stride);
+
+/*! @brief Gets the number of windows dropped since streaming was started.
+ *
+ *  @return uint16_t - The number of dropped windows, saturating at 0xFFFF.
+ */
+uint16_t Stream_GetDropped(void);
+
+#endif
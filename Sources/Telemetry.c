@@ -0,0 +1,142 @@
+/*! @file
+ *
+ *  @brief Routines to push measurements to the PC without it having to poll.
+ *
+ *  This contains the functions for subscribing to measurements and sending them periodically or on change.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Telemetry_module Telemetry module documentation
+**  @{
+*/
+/* MODULE Telemetry */
+
+#include "Telemetry.h"
+#include "packet.h"
+#include "handle.h"
+#include "OS.h"
+
+/*!
+ * @struct TSubscription
+ */
+typedef struct
+{
+  uint8_t period;         /*!< Push every period updates, or 0 for on change only */
+  uint8_t deadband;       /*!< Push when the value moves by more than this, or 0 for periodic only */
+  uint8_t elapsed;        /*!< Updates since the last push */
+  bool pushed;            /*!< TRUE once lastValue holds a pushed value */
+  uint16_t lastValue;     /*!< The value last pushed */
+  uint8_t changes;        /*!< Counts COMMAND_SUBSCRIBEs, so an update can tell it was overtaken by one */
+} TSubscription;
+
+/*!
+ * @brief The packet each measurement is pushed as - the same packet as the reply to polling it.
+ */
+static const struct
+{
+  uint8_t command;
+  uint8_t parameter1;
+} SourcePackets[TELEMETRY_NB_SOURCES] =
+{
+  [TELEMETRY_RMS_0]     = {COMMAND_VOLTAGE, 0},
+  [TELEMETRY_RMS_1]     = {COMMAND_VOLTAGE, 1},
+  [TELEMETRY_RMS_2]     = {COMMAND_VOLTAGE, 2},
+  [TELEMETRY_FREQUENCY] = {COMMAND_FREQUENCY, 0},
+  [TELEMETRY_NB_RAISES] = {COMMAND_NB_RAISES, 0},
+  [TELEMETRY_NB_LOWERS] = {COMMAND_NB_LOWERS, 0},
+  [TELEMETRY_ALARMS]    = {COMMAND_ALARM, 0}
+};
+
+static TSubscription Subscriptions[TELEMETRY_NB_SOURCES];
+
+/*! @brief Handles COMMAND_SUBSCRIBE.
+ *
+ *  Parameter 1 is the TTelemetrySource, parameter 2 the period in updates and parameter 3 the deadband.
+ *  A period and deadband of 0 cancels the subscription.
+ *  @param packet A pointer to the received packet.
+ *  @return bool - TRUE if the subscription was changed.
+ */
+static bool HandleSubscribeCommand(const TPacket* const packet)
+{
+  TSubscription* subscription;
+
+  if (Packet_Parameter1(packet) >= TELEMETRY_NB_SOURCES)
+    return false;
+
+  subscription = &Subscriptions[Packet_Parameter1(packet)];
+
+  // Telemetry_Update only ever sees the old subscription or the new one, never a mix
+  OS_DisableInterrupts();
+  subscription->period = Packet_Parameter2(packet);
+  subscription->deadband = Packet_Parameter3(packet);
+  // The first push goes out on the next update, whatever the new settings are
+  subscription->elapsed = 0;
+  subscription->pushed = false;
+  subscription->changes++;
+  OS_EnableInterrupts();
+
+  return true;
+}
+
+bool Telemetry_Init(void)
+{
+  for (uint8_t source = 0; source < TELEMETRY_NB_SOURCES; source++)
+  {
+    Subscriptions[source].period = 0;
+    Subscriptions[source].deadband = 0;
+  }
+
+  return Handle_Register(COMMAND_SUBSCRIBE, HandleSubscribeCommand);
+}
+
+void Telemetry_Update(const uint16_t values[TELEMETRY_NB_SOURCES])
+{
+  for (uint8_t source = 0; source < TELEMETRY_NB_SOURCES; source++)
+  {
+    TSubscription* const subscription = &Subscriptions[source];
+    TSubscription settings;
+    uint16union_t value;
+    bool due;
+
+    // COMMAND_SUBSCRIBE is handled on a higher priority thread, so work from a copy taken whole
+    OS_DisableInterrupts();
+    if (((subscription->period != 0) || (subscription->deadband != 0)) && (subscription->elapsed < 0xFF))
+      subscription->elapsed++;
+    settings = *subscription;
+    OS_EnableInterrupts();
+
+    if ((settings.period == 0) && (settings.deadband == 0))
+      continue;
+
+    value.l = values[source];
+
+    due = !settings.pushed;
+    due |= (settings.period != 0) && (settings.elapsed >= settings.period);
+    if (settings.deadband != 0)
+    {
+      uint16_t change = (value.l > settings.lastValue) ? (value.l - settings.lastValue) :
+                                                         (settings.lastValue - value.l);
+      due |= (change > settings.deadband);
+    }
+
+    // A full transmit queue just delays the push to the next update
+    if (due && Packet_Put(SourcePackets[source].command, SourcePackets[source].parameter1, value.s.Lo, value.s.Hi))
+    {
+      // A subscription changed meanwhile starts afresh, and gets its first push on the next update
+      OS_DisableInterrupts();
+      if (subscription->changes == settings.changes)
+      {
+        subscription->elapsed = 0;
+        subscription->pushed = true;
+        subscription->lastValue = value.l;
+      }
+      OS_EnableInterrupts();
+    }
+  }
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,48 @@
+/*! @file
+ *
+ *  @brief Routines to push measurements to the PC without it having to poll.
+ *
+ *  This contains the functions for subscribing to measurements and sending them periodically or on change.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+// new types
+#include "types.h"
+
+/*! @brief Measurements that can be subscribed to.
+ *
+ */
+typedef enum
+{
+  TELEMETRY_RMS_0,      /*!< RMS of channel 0, pushed as COMMAND_VOLTAGE */
+  TELEMETRY_RMS_1,      /*!< RMS of channel 1, pushed as COMMAND_VOLTAGE */
+  TELEMETRY_RMS_2,      /*!< RMS of channel 2, pushed as COMMAND_VOLTAGE */
+  TELEMETRY_FREQUENCY,  /*!< Frequency in 0.01 Hz, pushed as COMMAND_FREQUENCY */
+  TELEMETRY_NB_RAISES,  /*!< Number of raises, pushed as COMMAND_NB_RAISES */
+  TELEMETRY_NB_LOWERS,  /*!< Number of lowers, pushed as COMMAND_NB_LOWERS */
+  TELEMETRY_ALARMS,     /*!< Bit n set if channel n is in alarm, pushed as COMMAND_ALARM */
+  TELEMETRY_NB_SOURCES
+} TTelemetrySource;
+
+/*! @brief Sets up the telemetry module before first use.
+ *
+ *  Clears all subscriptions and registers the handler for COMMAND_SUBSCRIBE.
+ *  @return bool - TRUE if the telemetry module was successfully initialized.
+ */
+bool Telemetry_Init(void);
+
+/*! @brief Pushes the subscribed measurements that are due.
+ *
+ *  A measurement is due when its period (in updates) has passed, or when it has moved by more
+ *  than its deadband since it was last pushed.
+ *  @param values The latest value of every measurement, indexed by TTelemetrySource.
+ *  @note Called once per housekeeping period.
+ */
+void Telemetry_Update(const uint16_t values[TELEMETRY_NB_SOURCES]);
+
+#endif
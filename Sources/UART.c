@@ -16,39 +16,170 @@
 #include "UART.h"
 #include "Cpu.h"
 #include "OS.h"
-#include "FIFO.h"
+#include "packet.h"
 
-static FIFO_t RxFIFO;
-static FIFO_t TxFIFO;
+// Size of the receive ring - must be a power of 2 so the indices can wrap by masking
+#define RX_RING_SIZE 256
+// Preferred receive FIFO watermark - limited by the depth of the UART2 hardware FIFO
+#define RX_WATERMARK 4
 
-static OS_ECB* ByteReceived;
-static OS_ECB* TransmitReady;
-static uint8_t RxByte;
+// Number of frames that can be queued for transmission - must be a power of 2
+#define TX_QUEUE_SIZE 16
+// eDMA channel that moves transmit frames into UART2_D
+#define TX_DMA_CHANNEL 0
+// DMAMUX0 request source for UART2 transmit
+#define TX_DMAMUX_SOURCE 7
+
+/*!
+ * @struct RxRing_t
+ * @brief Lock-free single producer (UART_ISR), single consumer (UART_InChar) receive ring.
+ */
+typedef struct
+{
+  volatile uint16_t Head;             /*!< Free-running count of bytes written, only modified by UART_ISR */
+  volatile uint16_t Tail;             /*!< Free-running count of bytes read, only modified by UART_InChar */
+  volatile uint16_t Overruns;         /*!< Number of bytes dropped because the ring was full */
+  volatile bool WakePending;          /*!< TRUE once Packet_ByteReady has been signalled and the ring not yet emptied */
+  uint8_t Buffer[RX_RING_SIZE];       /*!< The actual array of bytes to store the data */
+} RxRing_t;
+
+/*!
+ * @struct TxDescriptor_t
+ * @brief A frame waiting to be sent by the transmit DMA channel.
+ */
+typedef struct
+{
+  const uint8_t* Data;                /*!< The caller's buffer, or NULL if the frame was copied into Bytes */
+  volatile bool* Busy;                /*!< Cleared once the caller's buffer has been sent, may be NULL */
+  uint16_t Length;                    /*!< Number of bytes in the frame */
+  uint8_t Bytes[UART_TX_FRAME_SIZE];  /*!< A copy of a short frame, so the caller's buffer can be reused immediately */
+} TxDescriptor_t;
+
+/*!
+ * @struct TxQueue_t
+ * @brief Queue of frames for the transmit DMA channel.
+ */
+typedef struct
+{
+  volatile uint8_t Head;              /*!< Free-running count of frames queued */
+  volatile uint8_t Tail;              /*!< Free-running count of frames sent, only modified by UART_TxDMAISR */
+  volatile bool Busy;                 /*!< TRUE while the DMA channel is sending the frame at Tail */
+  TxDescriptor_t Frames[TX_QUEUE_SIZE];
+} TxQueue_t;
+
+static RxRing_t RxRing;
+static TxQueue_t TxQueue;
 
 const uint8_t BAUD_MULTIPLIER = 32;
 
+// Largest value of the 13-bit SBR field
+#define SBR_MAX 0x1FFF
+
+static uint32_t BaudRate;
+
 extern OS_ECB* Packet_ByteReady;
 
-bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk)
+/*! @brief Places a received byte in the receive ring.
+ *
+ *  @param data The received byte.
+ *  @note Must only be called from the producer side (UART_ISR or UART_Poll).
+ */
+static inline void RxRingPut(const uint8_t data)
 {
-  // init private globals
-  ByteReceived = OS_SemaphoreCreate(0);
-  TransmitReady = OS_SemaphoreCreate(0);
-  FIFO_Init(&RxFIFO);
-  FIFO_Init(&TxFIFO);
+  uint16_t head = RxRing.Head;
 
-  // baud rate 0 turns off UART
-  if (baudRate != 0)
+  if ((uint16_t)(head - RxRing.Tail) >= RX_RING_SIZE)
   {
-    uint8_t BRFA;
-    uint16union_t SBR;
-    uint16_t baudRateCalc;
+    RxRing.Overruns++;
+    return;
+  }
 
-    // Calculate UART Baud Rate Bits (SBR) and Baud Rate Fine Adjust (BRFA)
-    baudRateCalc = 2*(moduleClk/(baudRate));
+  RxRing.Buffer[head & (RX_RING_SIZE - 1)] = data;
+  // Make sure the byte is in the buffer before the consumer can see the new head
+  __asm volatile ("" ::: "memory");
+  RxRing.Head = head + 1;
+}
 
-    SBR.l = baudRateCalc / BAUD_MULTIPLIER;
-    BRFA  = baudRateCalc % BAUD_MULTIPLIER;
+/*! @brief Calculates the baud rate divisor.
+ *
+ *  The baud rate is moduleClk / (16 * (SBR + BRFA / 32)), so the divisor is worked out in 1/32 steps.
+ *  @param baudRate The desired baud rate in bits/sec.
+ *  @param moduleClk The module clock rate in Hz.
+ *  @param divisor A pointer to where SBR * 32 + BRFA is written.
+ *  @return bool - TRUE if the divisor fits in SBR and BRFA and is accurate enough.
+ */
+static bool BaudDivisor(const uint32_t baudRate, const uint32_t moduleClk, uint32_t* const divisor)
+{
+  uint32_t actual, error;
+
+  if (baudRate == 0)
+    return false;
+
+  // 32 * moduleClk / (16 * baudRate), rounded to the nearest step
+  *divisor = ((2 * moduleClk) + (baudRate / 2)) / baudRate;
+
+  // SBR of 0 disables the baud rate generator
+  if ((*divisor < BAUD_MULTIPLIER) || (*divisor > ((SBR_MAX + 1) * BAUD_MULTIPLIER - 1)))
+    return false;
+
+  actual = (2 * moduleClk) / *divisor;
+  error = (actual > baudRate) ? (actual - baudRate) : (baudRate - actual);
+
+  return (error * 100) <= (baudRate * UART_MAX_BAUD_ERROR);
+}
+
+bool UART_BaudRateValid(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  uint32_t divisor;
+
+  return BaudDivisor(baudRate, moduleClk, &divisor);
+}
+
+bool UART_SetBaudRate(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  uint32_t divisor;
+  uint16union_t SBR;
+
+  if (!BaudDivisor(baudRate, moduleClk, &divisor))
+    return false;
+
+  SBR.l = divisor / BAUD_MULTIPLIER;
+
+  // The new divisor takes effect when BDL is written, so BDH and BRFA go first
+  UART2_BDH = (UART2_BDH & ~UART_BDH_SBR_MASK) | UART_BDH_SBR(SBR.s.Hi);
+  UART2_C4 = (UART2_C4 & ~UART_C4_BRFA_MASK) | UART_C4_BRFA(divisor % BAUD_MULTIPLIER);
+  UART2_BDL = UART_BDL_SBR(SBR.s.Lo);
+
+  BaudRate = baudRate;
+
+  return true;
+}
+
+uint32_t UART_GetBaudRate(void)
+{
+  return BaudRate;
+}
+
+bool UART_TxIdle(void)
+{
+  return !TxQueue.Busy && (TxQueue.Tail == TxQueue.Head) && (UART2_S1 & UART_S1_TC_MASK);
+}
+
+bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  // init private globals
+  RxRing.Head = 0;
+  RxRing.Tail = 0;
+  RxRing.Overruns = 0;
+  RxRing.WakePending = false;
+  TxQueue.Head = 0;
+  TxQueue.Tail = 0;
+  TxQueue.Busy = false;
+
+  // baud rate 0 turns off UART, and a rate that cannot be generated is refused
+  if (UART_BaudRateValid(baudRate, moduleClk))
+  {
+    uint8_t rxFifoDepth;
 
     // Enable UART2
     SIM_SCGC4 |= SIM_SCGC4_UART2_MASK;
@@ -61,16 +192,44 @@ bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk)
     PORTE_PCR17 = PORT_PCR_MUX(3);
 
     // Initialize baud rate
-    UART2_BDH = UART_BDH_SBR(SBR.s.Hi);
-    UART2_BDL = UART_BDL_SBR(SBR.s.Lo);
+    (void)UART_SetBaudRate(baudRate, moduleClk);
+
+    // Enable the receive FIFO - UART2 may have a shallower FIFO than UART0/1, so read its depth back
+    rxFifoDepth = UART2_PFIFO & UART_PFIFO_RXFIFOSIZE_MASK;
+    rxFifoDepth = (rxFifoDepth == 0) ? 1 : (1 << (rxFifoDepth + 1));
+    UART2_PFIFO |= UART_PFIFO_RXFE_MASK;
+    UART2_CFIFO |= UART_CFIFO_RXFLUSH_MASK;
 
-    UART2_C4 |= UART_C4_BRFA_MASK;
-    UART2_C4 &= (BRFA |= ~(UART_C4_BRFA_MASK));
+    // Interrupt once the watermark is reached, leaving one slot of headroom while the ISR is entered
+    UART2_RWFIFO = UART_RWFIFO_RXWATER((rxFifoDepth > RX_WATERMARK) ? RX_WATERMARK :
+                                       (rxFifoDepth > 1) ? (rxFifoDepth - 1) : 1);
 
-    // Set receiver interrupt flag
+    // Start counting idle characters after the stop bit so a burst tail below the watermark is flushed
+    UART2_C1 |= UART_C1_ILT_MASK;
+
+    // Set receiver and idle line interrupt flags
     UART2_C2 |= UART_C2_RIE_MASK;
+    UART2_C2 |= UART_C2_ILIE_MASK;
     UART2_C2 &= ~UART_C2_TIE_MASK;
 
+    // Route transmit data register empty to the DMA rather than the CPU
+    UART2_C5 |= UART_C5_TDMAS_MASK;
+
+    // Enable eDMA and DMAMUX0, then tie the transmit channel to UART2 transmit
+    SIM_SCGC6 |= SIM_SCGC6_DMAMUX0_MASK;
+    SIM_SCGC7 |= SIM_SCGC7_DMA_MASK;
+    DMAMUX0_CHCFG(TX_DMA_CHANNEL) = 0;
+    DMAMUX0_CHCFG(TX_DMA_CHANNEL) = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(TX_DMAMUX_SOURCE);
+
+    // Fixed part of the transfer: one byte per request from the frame into UART2_D
+    DMA_SOFF(TX_DMA_CHANNEL)  = 1;
+    DMA_ATTR(TX_DMA_CHANNEL)  = DMA_ATTR_SSIZE(0) | DMA_ATTR_DSIZE(0);
+    DMA_NBYTES_MLNO(TX_DMA_CHANNEL) = DMA_NBYTES_MLNO_NBYTES(1);
+    DMA_SLAST(TX_DMA_CHANNEL) = 0;
+    DMA_DADDR(TX_DMA_CHANNEL) = (uint32_t)&UART2_D;
+    DMA_DOFF(TX_DMA_CHANNEL)  = 0;
+    DMA_DLAST_SGA(TX_DMA_CHANNEL) = 0;
+
     // Initialize transmitter and receiver
     UART2_C2 |= UART_C2_RE_MASK;
     UART2_C2 |= UART_C2_TE_MASK;
@@ -80,6 +239,9 @@ bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk)
     // 49 mod 32 = 17;
     NVICICPR1 = (1 << 17);
     NVICISER1 = (1 << 17);
+    // Enable DMA channel 0 NVIC; IRQ = 0
+    NVICICPR0 = (1 << TX_DMA_CHANNEL);
+    NVICISER0 = (1 << TX_DMA_CHANNEL);
     OS_EnableInterrupts();
 
     return true;
@@ -88,57 +250,142 @@ bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk)
   return false;
 }
 
-void UART_InChar(uint8_t * const dataPtr)
+bool UART_InChar(uint8_t * const dataPtr)
 {
-//  UART2_C2 |= UART_C2_RIE_MASK;
-  FIFO_Get(&RxFIFO, dataPtr);
-//  //Use RxFIFO to get the incoming Bytes from the PC
-//if (FIFO_Get(&RxFIFO, dataPtr))
-//{
-//  // Set RIE Flag
-//  UART2_C2 |= UART_C2_RIE_MASK; // never turn off
-//  return true;
-//}
-//else
-//  return false;
+  uint16_t tail = RxRing.Tail;
+
+  if (tail == RxRing.Head)
+  {
+    // The reader is about to go back to sleep, so the next burst must wake it - recheck in case a byte just arrived
+    RxRing.WakePending = false;
+    __asm volatile ("" ::: "memory");
+    if (tail == RxRing.Head)
+      return false;
+  }
+
+  *dataPtr = RxRing.Buffer[tail & (RX_RING_SIZE - 1)];
+  // Finish reading the byte before handing the slot back to UART_ISR
+  __asm volatile ("" ::: "memory");
+  RxRing.Tail = tail + 1;
+
+  return true;
 }
 
-void UART_OutChar(const uint8_t data)
+uint16_t UART_InCount(void)
 {
-  FIFO_Put(&TxFIFO, data);
-  UART2_C2 |= UART_C2_TIE_MASK;
+  return (uint16_t)(RxRing.Head - RxRing.Tail);
 }
 
+/*! @brief Starts the DMA channel on the oldest queued frame if it is idle.
+ *
+ *  @note Must be called from within a critical section or from UART_TxDMAISR.
+ */
+static void TxStart(void)
+{
+  TxDescriptor_t* frame;
+
+  if (TxQueue.Busy || (TxQueue.Tail == TxQueue.Head))
+    return;
+
+  frame = &TxQueue.Frames[TxQueue.Tail & (TX_QUEUE_SIZE - 1)];
 
-void UART_ReceiveThread(void* pData)
+  DMA_SADDR(TX_DMA_CHANNEL) = (uint32_t)(frame->Data ? frame->Data : frame->Bytes);
+  DMA_CITER_ELINKNO(TX_DMA_CHANNEL) = DMA_CITER_ELINKNO_CITER(frame->Length);
+  DMA_BITER_ELINKNO(TX_DMA_CHANNEL) = DMA_BITER_ELINKNO_BITER(frame->Length);
+  // Interrupt when the frame is done, and stop taking requests until the next frame is loaded
+  DMA_CSR(TX_DMA_CHANNEL) = DMA_CSR_INTMAJOR_MASK | DMA_CSR_DREQ_MASK;
+
+  TxQueue.Busy = true;
+  DMA_SERQ = DMA_SERQ_SERQ(TX_DMA_CHANNEL);
+  // With TDMAS set, TIE raises DMA requests instead of interrupts
+  UART2_C2 |= UART_C2_TIE_MASK;
+}
+
+/*! @brief Queues a frame for the transmit DMA channel.
+ *
+ *  @param data A pointer to the bytes of the frame.
+ *  @param length The number of bytes in the frame.
+ *  @param busy NULL to copy the frame, otherwise a flag that is cleared once the frame has been sent from data.
+ *  @return bool - TRUE if the frame was queued.
+ */
+static bool TxQueueFrame(const uint8_t* const data, const uint16_t length, volatile bool* const busy)
 {
-  for (;;)
+  TxDescriptor_t* frame;
+
+  if ((length == 0) || (length > DMA_CITER_ELINKNO_CITER_MASK) || (!busy && (length > UART_TX_FRAME_SIZE)))
+    return false;
+
+  EnterCritical();
+
+  // Only the slot is claimed here; interrupts are not held off while the frame is on the wire
+  if ((uint8_t)(TxQueue.Head - TxQueue.Tail) >= TX_QUEUE_SIZE)
   {
-    OS_ERROR error = OS_SemaphoreWait(ByteReceived, 0);
+    ExitCritical();
+    return false;
+  }
 
-    if (error == OS_NO_ERROR)
-    {
-      FIFO_Put(&RxFIFO,RxByte);
-      OS_SemaphoreSignal(Packet_ByteReady);
-    }
+  frame = &TxQueue.Frames[TxQueue.Head & (TX_QUEUE_SIZE - 1)];
+  if (busy)
+  {
+    *busy = true;
+    frame->Data = data;
   }
+  else
+  {
+    for (uint8_t i = 0; i < length; i++)
+      frame->Bytes[i] = data[i];
+    frame->Data = NULL;
+  }
+  frame->Busy = busy;
+  frame->Length = length;
+  TxQueue.Head++;
+
+  TxStart();
+
+  ExitCritical();
+
+  return true;
 }
 
-void UART_TransmitThread(void* pData)
+bool UART_OutFrame(const uint8_t* const data, const uint8_t length)
 {
-  for (;;)
-  {
-    OS_ERROR error;
-    error = OS_SemaphoreWait(TransmitReady, 0);
-    if (error == OS_NO_ERROR)
-    {
-      if (UART2_S1 & UART_S1_TDRE_MASK)
-      {
-	FIFO_Get(&TxFIFO,(uint8_t*)&UART2_D);
-	UART2_C2 |= UART_C2_TIE_MASK;
-      }
-    }
-  }
+  return TxQueueFrame(data, length, NULL);
+}
+
+bool UART_OutBuffer(const uint8_t* const data, const uint16_t length, volatile bool* const busy)
+{
+  if (!busy)
+    return false;
+
+  return TxQueueFrame(data, length, busy);
+}
+
+bool UART_OutChar(const uint8_t data)
+{
+  return UART_OutFrame(&data, 1);
+}
+
+/*! @brief Interrupt service routine for the UART transmit DMA channel.
+ *
+ *  Releases the frame that has just been sent and starts the next one.
+ *  @note Assumes the UART has been initialised.
+ */
+void __attribute__ ((interrupt)) UART_TxDMAISR(void)
+{
+  OS_ISREnter();
+
+  DMA_CINT = DMA_CINT_CINT(TX_DMA_CHANNEL);
+  UART2_C2 &= ~UART_C2_TIE_MASK;
+
+  // Hand the caller's buffer back
+  if (TxQueue.Frames[TxQueue.Tail & (TX_QUEUE_SIZE - 1)].Busy)
+    *TxQueue.Frames[TxQueue.Tail & (TX_QUEUE_SIZE - 1)].Busy = false;
+
+  TxQueue.Tail++;
+  TxQueue.Busy = false;
+  TxStart();
+
+  OS_ISRExit();
 }
 
 
@@ -155,26 +402,32 @@ void __attribute__ ((interrupt)) UART_ISR(void)
   uint8_t statusReg = UART2_S1;
   uint8_t controlReg = UART2_C2;
 
-  // Receive thread with semaphores
-  // Check RIE Flag
-  if (controlReg & UART_C2_RIE_MASK)
+  // Drain the hardware receive FIFO straight into the receive ring
+  if (controlReg & (UART_C2_RIE_MASK | UART_C2_ILIE_MASK))
   {
-    if (statusReg & UART_S1_RDRF_MASK)
+    uint8_t nbReceived = 0;
+
+    // Reading S1 above followed by D clears RDRF, IDLE and OR
+    while (UART2_RCFIFO > 0)
     {
-    //Check if there is a Byte coming in, then put that info
-      RxByte = UART2_D;
-      OS_SemaphoreSignal(ByteReceived);
+      RxRingPut(UART2_D);
+      nbReceived++;
     }
-  }
 
-  // Transmit thread with semaphores
-  if (controlReg & UART_C2_TIE_MASK)
-  {
-    //Check if there is a Byte going out, then get that info
-    if (statusReg & UART_S1_TDRE_MASK)
+    if ((statusReg & UART_S1_IDLE_MASK) && (nbReceived == 0))
     {
-      UART2_C2 &= ~UART_C2_TIE_MASK;
-      OS_SemaphoreSignal(TransmitReady);
+      // Nothing left to read, so clear IDLE with a dummy read and discard the resulting underflow
+      (void)UART2_D;
+      UART2_CFIFO |= UART_CFIFO_RXFLUSH_MASK;
+      UART2_SFIFO = UART_SFIFO_RXUF_MASK;
+    }
+
+    // Only wake the packet parser once per burst, when a whole packet may be waiting or the line has gone quiet
+    if (!RxRing.WakePending &&
+        ((UART_InCount() >= PACKET_NB_BYTES) || ((statusReg & UART_S1_IDLE_MASK) && (UART_InCount() > 0))))
+    {
+      RxRing.WakePending = true;
+      OS_SemaphoreSignal(Packet_ByteReady);
     }
   }
 
@@ -187,13 +440,7 @@ void UART_Poll(void)
   //Check if there is a Byte coming in, then put that info
   if (statusReg & UART_S1_RDRF_MASK)
   {
-    FIFO_Put(&RxFIFO,UART2_D);
-  }
-
-  //Check if there is a Byte going out, then get that info
-  if (statusReg & UART_S1_TDRE_MASK)
-  {
-    FIFO_Get(&TxFIFO,(uint8_t*)&UART2_D);
+    RxRingPut(UART2_D);
   }
 }
 
@@ -14,6 +14,12 @@
 // new types
 #include "types.h"
 
+// Largest frame that UART_OutFrame can copy for transmission
+#define UART_TX_FRAME_SIZE 16
+
+// Largest acceptable difference between the requested and the generated baud rate, in percent
+#define UART_MAX_BAUD_ERROR 3
+
 /*! @brief Sets up the UART interface before first use.
  *
  *  @param baudRate The desired baud rate in bits/sec.
@@ -21,14 +27,52 @@
  *  @return bool - TRUE if the UART was successfully initialized.
  */
 bool UART_Init(const uint32_t baudRate, const uint32_t moduleClk);
+
+/*! @brief Checks whether a baud rate can be generated closely enough from the module clock.
+ *
+ *  @param baudRate The desired baud rate in bits/sec.
+ *  @param moduleClk The module clock rate in Hz.
+ *  @return bool - TRUE if the generated rate is within UART_MAX_BAUD_ERROR percent of baudRate.
+ */
+bool UART_BaudRateValid(const uint32_t baudRate, const uint32_t moduleClk);
+
+/*! @brief Changes the baud rate.
+ *
+ *  @param baudRate The desired baud rate in bits/sec.
+ *  @param moduleClk The module clock rate in Hz.
+ *  @return bool - TRUE if the baud rate was changed, FALSE if it cannot be generated closely enough.
+ *  @note Assumes that UART_Init has been called. Anything still being sent is corrupted, so wait for UART_TxIdle first.
+ */
+bool UART_SetBaudRate(const uint32_t baudRate, const uint32_t moduleClk);
+
+/*! @brief Gets the baud rate last set.
+ *
+ *  @return uint32_t - The requested baud rate in bits/sec.
+ */
+uint32_t UART_GetBaudRate(void);
+
+/*! @brief Checks whether everything queued for transmission has left the UART.
+ *
+ *  @return bool - TRUE if the transmit queue is empty and the last stop bit has been sent.
+ *  @note Assumes that UART_Init has been called.
+ */
+bool UART_TxIdle(void);
  
 /*! @brief Get a character from the receive FIFO if it is not empty.
  *
  *  @param dataPtr A pointer to memory to store the retrieved byte.
  *  @return bool - TRUE if the receive FIFO returned a character.
  *  @note Assumes that UART_Init has been called.
+ *  @note Never blocks - the receive FIFO is filled directly by UART_ISR.
  */
-void UART_InChar(uint8_t* const dataPtr);
+bool UART_InChar(uint8_t* const dataPtr);
+
+/*! @brief Gets the number of received bytes waiting in the receive FIFO.
+ *
+ *  @return uint16_t - The number of bytes that UART_InChar can return without waiting.
+ *  @note Assumes that UART_Init has been called.
+ */
+uint16_t UART_InCount(void);
  
 /*! @brief Put a byte in the transmit FIFO if it is not full.
  *
@@ -36,9 +80,28 @@ void UART_InChar(uint8_t* const dataPtr);
  *  @return bool - TRUE if the data was placed in the transmit FIFO.
  *  @note Assumes that UART_Init has been called.
  */
-void UART_OutChar(const uint8_t data);
+bool UART_OutChar(const uint8_t data);
 
-/*! @brief Poll the UART status register to try and receive and/or transmit one character.
+/*! @brief Queue a whole frame to be sent by DMA.
+ *
+ *  @param data A pointer to the bytes of the frame - copied, so it may be reused on return.
+ *  @param length The number of bytes in the frame, at most UART_TX_FRAME_SIZE.
+ *  @return bool - TRUE if the frame was queued, FALSE if the queue is full or the length is invalid.
+ *  @note Assumes that UART_Init has been called.
+ */
+bool UART_OutFrame(const uint8_t* const data, const uint8_t length);
+
+/*! @brief Queue a frame to be sent by DMA straight from the caller's buffer.
+ *
+ *  @param data A pointer to the bytes of the frame - must not change until busy is cleared.
+ *  @param length The number of bytes in the frame.
+ *  @param busy A flag that is set when the frame is queued and cleared from the DMA interrupt once it has been sent.
+ *  @return bool - TRUE if the frame was queued, FALSE if the queue is full or the length is invalid.
+ *  @note Assumes that UART_Init has been called.
+ */
+bool UART_OutBuffer(const uint8_t* const data, const uint16_t length, volatile bool* const busy);
+
+/*! @brief Poll the UART status register to try and receive one character.
  *
  *  @return void
  *  @note Assumes that UART_Init has been called.
@@ -51,8 +114,10 @@ void UART_Poll(void);
  */
 void __attribute__ ((interrupt)) UART_ISR(void);
 
-void UART_ReceiveThread(void * pd);
-
-void UART_TransmitThread(void * pd);
+/*! @brief Interrupt service routine for the UART transmit DMA channel.
+ *
+ *  @note Assumes the UART has been initialized.
+ */
+void __attribute__ ((interrupt)) UART_TxDMAISR(void);
 
 #endif
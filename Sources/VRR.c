@@ -26,6 +26,8 @@ int16_t VRR_CalcDeviation(int16_t value)
   {
     return VOLT(2.5) - value;
   }
+
+  return 0;
 }
 
 
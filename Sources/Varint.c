@@ -0,0 +1,73 @@
+/*! @file
+ *
+ *  @brief Routines to pack integers into variable length byte sequences.
+ *
+ *  This contains the functions for LEB128 style varints, with zig-zag coding for signed values so that
+ *  small deltas of either sign take a single byte.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+/*!
+**  @addtogroup Varint_module Varint module documentation
+**  @{
+*/
+/* MODULE Varint */
+
+#include "Varint.h"
+
+// Each byte carries 7 bits of the value, with the top bit set when more bytes follow
+#define VARINT_MORE 0x80
+#define VARINT_BITS 0x7F
+
+uint8_t Varint_Put(uint8_t* const buffer, uint32_t value)
+{
+  uint8_t count = 0;
+
+  while (value > VARINT_BITS)
+  {
+    buffer[count++] = (uint8_t)(value | VARINT_MORE);
+    value >>= 7;
+  }
+  buffer[count++] = (uint8_t)value;
+
+  return count;
+}
+
+uint8_t Varint_PutSigned(uint8_t* const buffer, const int32_t value)
+{
+  // Zig-zag: 0, -1, 1, -2, 2... map to 0, 1, 2, 3, 4...
+  return Varint_Put(buffer, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+uint8_t Varint_Get(const uint8_t* const buffer, const uint16_t length, uint32_t* const value)
+{
+  uint32_t result = 0;
+
+  for (uint8_t count = 0; (count < length) && (count < VARINT_MAX_BYTES); count++)
+  {
+    result |= (uint32_t)(buffer[count] & VARINT_BITS) << (7 * count);
+    if ((buffer[count] & VARINT_MORE) == 0)
+    {
+      *value = result;
+      return count + 1;
+    }
+  }
+
+  return 0;
+}
+
+uint8_t Varint_GetSigned(const uint8_t* const buffer, const uint16_t length, int32_t* const value)
+{
+  uint32_t zigzag;
+  uint8_t count = Varint_Get(buffer, length, &zigzag);
+
+  if (count)
+    *value = (int32_t)((zigzag >> 1) ^ -(zigzag & 1));
+
+  return count;
+}
+
+/*!
+** @}
+*/
@@ -0,0 +1,58 @@
+/*! @file
+ *
+ *  @brief Routines to pack integers into variable length byte sequences.
+ *
+ *  This contains the functions for LEB128 style varints, with zig-zag coding for signed values so that
+ *  small deltas of either sign take a single byte.
+ *
+ *  @author 12604120, 12931717
+ *  @date 2026-10-19
+ */
+
+#ifndef VARINT_H
+#define VARINT_H
+
+// new types
+#include "types.h"
+
+// Longest encoding of a 32-bit value
+#define VARINT_MAX_BYTES 5
+
+// Longest encoding of a 16-bit value after zig-zag coding
+#define VARINT_MAX_BYTES_16 3
+
+/*! @brief Writes an unsigned value as a varint.
+ *
+ *  @param buffer A pointer to where the encoding is written - must have room for VARINT_MAX_BYTES.
+ *  @param value The value to encode.
+ *  @return uint8_t - The number of bytes written.
+ */
+uint8_t Varint_Put(uint8_t* const buffer, uint32_t value);
+
+/*! @brief Writes a signed value as a zig-zag coded varint.
+ *
+ *  @param buffer A pointer to where the encoding is written - must have room for VARINT_MAX_BYTES.
+ *  @param value The value to encode.
+ *  @return uint8_t - The number of bytes written.
+ */
+uint8_t Varint_PutSigned(uint8_t* const buffer, const int32_t value);
+
+/*! @brief Reads an unsigned varint.
+ *
+ *  @param buffer A pointer to the encoding.
+ *  @param length The number of bytes available at buffer.
+ *  @param value A pointer to where the decoded value is written.
+ *  @return uint8_t - The number of bytes read, or 0 if the encoding is truncated or too long.
+ */
+uint8_t Varint_Get(const uint8_t* const buffer, const uint16_t length, uint32_t* const value);
+
+/*! @brief Reads a zig-zag coded signed varint.
+ *
+ *  @param buffer A pointer to the encoding.
+ *  @param length The number of bytes available at buffer.
+ *  @param value A pointer to where the decoded value is written.
+ *  @return uint8_t - The number of bytes read, or 0 if the encoding is truncated or too long.
+ */
+uint8_t Varint_GetSigned(const uint8_t* const buffer, const uint16_t length, int32_t* const value);
+
+#endif
@@ -14,9 +14,13 @@
 
 #include "types.h"
 #include "packet.h"
+#include "UART.h"
 #include "LEDs.h"
 #include "Flash.h"
 #include "PIT.h"
+#include "RMS.h"
+#include "Frequency.h"
+#include "Regulator.h"
 #include "OS.h"
 #include "handle.h"
 
@@ -56,6 +60,27 @@ static const uint8_t PARAMETER1_NB_LOWERS_RESET = 0x01;
 static const uint8_t PARAMETER2_NB_LOWERS_RESET = 0x00;
 static const uint8_t PARAMETER3_NB_LOWERS_RESET = 0x00;
 
+// Baud rates are sent in parameters 2 and 3 in units of 100 bits/sec
+static const uint8_t PARAMETER1_BAUD_RATE_GET     = 0x00;
+static const uint8_t PARAMETER1_BAUD_RATE_SET     = 0x01;
+static const uint8_t PARAMETER1_BAUD_RATE_CONFIRM = 0x02;
+static const uint32_t BAUD_RATE_UNIT = 100;
+
+// OS ticks (10 ms) the PC has to confirm a new baud rate before the old one is restored
+#define BAUD_RATE_CONFIRM_TICKS 200
+// OS ticks to wait for the acknowledgement to leave the UART before changing the baud rate anyway
+#define BAUD_RATE_DRAIN_TICKS 10
+
+/*! @brief Progress of a baud rate change.
+ *
+ */
+typedef enum
+{
+  BAUD_RATE_STEADY,     /*!< No change in progress. */
+  BAUD_RATE_SWITCH,     /*!< Change agreed - switch once the reply has been sent. */
+  BAUD_RATE_CONFIRM     /*!< Switched - waiting for the PC to confirm at the new rate. */
+} TBaudRateState;
+
 
 
 
@@ -72,14 +97,23 @@ extern bool InitSuccess;
 uint16union_t * NvTowerNb;
 uint16union_t * NvTowerMode;
 
-uint16union_t * RaisesNb;
-uint16union_t * LowersNb;
+// The tap change counts kept in flash by main.c
+extern uint16union_t * NbRaises;
+extern uint16union_t * NbLowers;
 
 TimerType Mode = DEFINITE;
 
+extern TFrequencyEstimator FrequencyEstimator;
+extern TRegulator Regulator;
+
 
 extern OS_ECB* Packet_ByteReady;
 
+static TBaudRateState BaudRateState = BAUD_RATE_STEADY;
+static uint32_t BaudRateNew;
+static uint32_t BaudRateOld;
+static uint32_t BaudRateDeadline;
+
 /******************************************************************************\
 *                                                                              *
 *   Functions                                                                  *
@@ -100,20 +134,24 @@ static bool SendTimingModePacket()
 }
 
 
-static bool HandleTimingCommand()
+static bool HandleTimingCommand(const TPacket* const packet)
 {
-  if (Packet_Parameter1 == PARAMETER1_TIMING_MODE_GET && Packet_Parameter2 == PARAMETER2_TIMING_MODE_GET && Packet_Parameter3 == PARAMETER3_TIMING_MODE_GET)
+  if (Packet_Parameter1(packet) == PARAMETER1_TIMING_MODE_GET && Packet_Parameter2(packet) == PARAMETER2_TIMING_MODE_GET && Packet_Parameter3(packet) == PARAMETER3_TIMING_MODE_GET)
   {
     return SendTimingModePacket();
   }
-  else if (Packet_Parameter1 == PARAMETER1_TIMING_MODE_SET_DEFINITE)
+  else if (Packet_Parameter1(packet) == PARAMETER1_TIMING_MODE_SET_DEFINITE && Packet_Parameter2(packet) == PARAMETER2_TIMING_MODE_SET_DEFINITE && Packet_Parameter3(packet) == PARAMETER3_TIMING_MODE_SET_DEFINITE)
   {
     Mode = DEFINITE;
+    return true;
   }
-  else if (Packet_Parameter1 == PARAMETER1_TIMING_MODE_SET_INVERSE)
+  else if (Packet_Parameter1(packet) == PARAMETER1_TIMING_MODE_SET_INVERSE && Packet_Parameter2(packet) == PARAMETER2_TIMING_MODE_SET_INVERSE && Packet_Parameter3(packet) == PARAMETER3_TIMING_MODE_SET_INVERSE)
   {
     Mode = INVERSE;
+    return true;
   }
+
+  return false;
 }
 
 static bool SendNbRaisesPacket()
@@ -122,23 +160,27 @@ static bool SendNbRaisesPacket()
   (
       COMMAND_NB_RAISES,
       PARAMETER1_NB_RAISES_GET,
-      RaisesNb,
-      PARAMETER3_NB_RAISES_GET
+      NbRaises->s.Lo,
+      NbRaises->s.Hi
   );
 
   return true;
 }
 
-static bool HandleNbRaisesCommand()
+static bool HandleNbRaisesCommand(const TPacket* const packet)
 {
-  if (Packet_Parameter1 == PARAMETER1_NB_RAISES_GET && Packet_Parameter2 == PARAMETER2_NB_RAISES_GET && Packet_Parameter3 == PARAMETER3_NB_RAISES_GET)
+  if (Packet_Parameter1(packet) == PARAMETER1_NB_RAISES_GET && Packet_Parameter2(packet) == PARAMETER2_NB_RAISES_GET && Packet_Parameter3(packet) == PARAMETER3_NB_RAISES_GET)
   {
     return SendNbRaisesPacket();
   }
-  else if (Packet_Parameter1 == PARAMETER2_NB_RAISES_RESET)
+  else if (Packet_Parameter1(packet) == PARAMETER1_NB_RAISES_RESET && Packet_Parameter2(packet) == PARAMETER2_NB_RAISES_RESET && Packet_Parameter3(packet) == PARAMETER3_NB_RAISES_RESET)
   {
-    return Flash_Write16(RaisesNb, 0);
+    // The regulator's count is what gets saved, so it starts again from zero too
+    Regulator.nbRaises = 0;
+    return Flash_Write16(&NbRaises->l, 0);
   }
+
+  return false;
 }
 
 static bool SendNbLowersPacket()
@@ -147,122 +189,203 @@ static bool SendNbLowersPacket()
   (
       COMMAND_NB_LOWERS,
       PARAMETER1_NB_LOWERS_GET,
-      LowersNb,
-      PARAMETER3_NB_LOWERS_GET
+      NbLowers->s.Lo,
+      NbLowers->s.Hi
   );
 
   return true;
 }
 
-static bool HandleNbLowersCommand()
+static bool HandleNbLowersCommand(const TPacket* const packet)
 {
-  if (Packet_Parameter1 == PARAMETER1_NB_RAISES_GET && Packet_Parameter2 == PARAMETER2_NB_RAISES_GET && Packet_Parameter3 == PARAMETER3_NB_RAISES_GET)
+  if (Packet_Parameter1(packet) == PARAMETER1_NB_LOWERS_GET && Packet_Parameter2(packet) == PARAMETER2_NB_LOWERS_GET && Packet_Parameter3(packet) == PARAMETER3_NB_LOWERS_GET)
   {
     return SendNbLowersPacket();
   }
-  else if (Packet_Parameter1 == PARAMETER2_NB_RAISES_RESET)
+  else if (Packet_Parameter1(packet) == PARAMETER1_NB_LOWERS_RESET && Packet_Parameter2(packet) == PARAMETER2_NB_LOWERS_RESET && Packet_Parameter3(packet) == PARAMETER3_NB_LOWERS_RESET)
   {
-    return Flash_Write16(LowersNb, 0);
+    // The regulator's count is what gets saved, so it starts again from zero too
+    Regulator.nbLowers = 0;
+    return Flash_Write16(&NbLowers->l, 0);
   }
+
+  return false;
 }
 
-static bool HandleFrequencyCommand()
+static bool HandleFrequencyCommand(const TPacket* const packet)
 {
-  return true;
+  uint16union_t frequency;
+
+  // Kept up to date by the sample pipeline, in 0.01 Hz
+  frequency.l = Frequency_Get(&FrequencyEstimator);
+
+  return Packet_Put(COMMAND_FREQUENCY, 0, frequency.s.Lo, frequency.s.Hi);
 }
 
-static bool HandleVoltageCommand()
+static bool HandleVoltageCommand(const TPacket* const packet)
 {
-  return true;
+  int16union_t rms;
+
+  // Served straight from the last published window - never recalculated here
+  if (!RMS_Get(Packet_Parameter1(packet), &rms.l))
+  {
+    return false;
+  }
+
+  return Packet_Put(COMMAND_VOLTAGE, Packet_Parameter1(packet), rms.s.Lo, rms.s.Hi);
 }
 
-static bool HandleSpectrumCommand()
+static bool HandleSpectrumCommand(const TPacket* const packet)
 {
   return true;
 }
 
+/*!
+ * @brief Handles COMMAND_BAUD_RATE.
+ *
+ * Setting a rate only agrees to it - the switch is made by Handle_PacketThread once the acknowledgement
+ * has gone out at the old rate. The PC must then confirm the same rate at the new rate.
+ * @param packet - The received packet.
+ * @return bool - TRUE if the request was accepted.
+ */
+static bool HandleBaudRateCommand(const TPacket* const packet)
+{
+  uint16union_t rate;
+  uint32_t baudRate = (uint32_t)Packet_Parameter23(packet) * BAUD_RATE_UNIT;
+
+  if (Packet_Parameter1(packet) == PARAMETER1_BAUD_RATE_GET)
+  {
+    rate.l = (uint16_t)(UART_GetBaudRate() / BAUD_RATE_UNIT);
+    return Packet_Put(COMMAND_BAUD_RATE, PARAMETER1_BAUD_RATE_GET, rate.s.Lo, rate.s.Hi);
+  }
+
+  if (Packet_Parameter1(packet) == PARAMETER1_BAUD_RATE_SET)
+  {
+    if ((BaudRateState != BAUD_RATE_STEADY) || !UART_BaudRateValid(baudRate, CPU_BUS_CLK_HZ))
+      return false;
+
+    BaudRateNew = baudRate;
+    BaudRateState = BAUD_RATE_SWITCH;
+    return true;
+  }
+
+  if (Packet_Parameter1(packet) == PARAMETER1_BAUD_RATE_CONFIRM)
+  {
+    if ((BaudRateState != BAUD_RATE_CONFIRM) || (baudRate != BaudRateNew))
+      return false;
+
+    BaudRateState = BAUD_RATE_STEADY;
+    return true;
+  }
+
+  return false;
+}
+
+static bool HandleProtocolCommand(const TPacket* const packet)
+{
+  // Parameter 1 selects the framing - the acknowledgement is the first reply in the new framing
+  return Packet_SetProtocol((TPacketProtocol)Packet_Parameter1(packet));
+}
+
 
 /*!
- * @brief Attempts to read in Packets and initiate packet commands if packet is valid.
+ * @brief Command handlers, indexed by command byte without the acknowledge bit.
+ */
+static Handle_Command_t CommandTable[HANDLE_NB_COMMANDS] =
+{
+  [COMMAND_TIMING_MODE] = HandleTimingCommand,
+  [COMMAND_NB_RAISES]   = HandleNbRaisesCommand,
+  [COMMAND_NB_LOWERS]   = HandleNbLowersCommand,
+  [COMMAND_FREQUENCY]   = HandleFrequencyCommand,
+  [COMMAND_VOLTAGE]     = HandleVoltageCommand,
+  [COMMAND_SPECTRUM]    = HandleSpectrumCommand,
+  [COMMAND_PROTOCOL]    = HandleProtocolCommand,
+  [COMMAND_BAUD_RATE]   = HandleBaudRateCommand
+};
+
+bool Handle_Register(const uint8_t command, const Handle_Command_t handler)
+{
+  if (command >= HANDLE_NB_COMMANDS)
+    return false;
+
+  CommandTable[command] = handler;
+  return true;
+}
+
+/*!
+ * @brief Runs the handler for a received packet and sends the acknowledgement if one was requested.
  *
+ * @param packet - The packet to handle.
  * @return Void.
  */
-static void HandlePacket()
+static void HandlePacket(const TPacket* const packet)
 {
   // Status of sent packet.
   bool packetSuccess = false;
-  // Was acknowledge requested.
-  bool sendAck = false;
+  // Command without the acknowledge bit, which also indexes the command table.
+  uint8_t command = Packet_Command(packet) & ~PACKET_ACK_MASK;
+  Handle_Command_t handler = CommandTable[command];
 
-  // Does Packet_Command have acknowledge bit set.
-  if ((Packet_Command & PACKET_ACK_MASK) != 0)
+  if (handler)
   {
-    sendAck = true;
+    packetSuccess = handler(packet);
   }
 
-  // Switch on Packet_Command ignoring acknowledge bit.
-  switch (Packet_Command & ~PACKET_ACK_MASK)
+  // Was acknowledge requested.
+  if ((Packet_Command(packet) & PACKET_ACK_MASK) != 0)
   {
-    case COMMAND_TIMING_MODE:
-    {
-      packetSuccess = HandleTimingCommand();
-      break;
-    }
-    case COMMAND_NB_RAISES:
-    {
-      packetSuccess = HandleNbRaisesCommand();
-      break;
-    }
-    case COMMAND_NB_LOWERS:
-    {
-      packetSuccess = HandleNbLowersCommand();
-      break;
-    }
-    case COMMAND_FREQUENCY:
-    {
-      packetSuccess = HandleFrequencyCommand();
-      break;
-    }
-    case COMMAND_VOLTAGE:
-    {
-      packetSuccess = HandleVoltageCommand();
-      break;
-    }
-    case COMMAND_SPECTRUM:
-    {
-      packetSuccess = HandleSpectrumCommand();
-      break;
-    }
-    default:
-    {
-      packetSuccess = false;
-      break;
-    }
+    // Send original command back with the acknowledge bit showing success or failure.
+    Packet_Put
+    (
+      packetSuccess ? (command | PACKET_ACK_MASK) : command,
+      Packet_Parameter1(packet),
+      Packet_Parameter2(packet),
+      Packet_Parameter3(packet)
+    );
   }
+}
 
-  // Check if FTM0_CH1 was successfully set & valid packet was received
+/*!
+ * @brief Moves a baud rate change on once the packets that arrived have been handled.
+ *
+ * @return uint32_t - The number of OS ticks to wait for the next packet, or 0 to wait forever.
+ */
+static uint32_t BaudRateUpdate(void)
+{
+  int32_t remaining;
 
-  if (sendAck)
+  switch (BaudRateState)
   {
-    if (packetSuccess)
-    {
-      // Add acknowledge bit.
-      Packet_Command |= PACKET_ACK_MASK;
-    }
-    else
-    {
-      // Remove acknowledge bit.
-      Packet_Command &= ~PACKET_ACK_MASK;
-    }
+    case BAUD_RATE_SWITCH:
+      // Let the acknowledgement finish at the old rate
+      for (uint8_t ticks = 0; (ticks < BAUD_RATE_DRAIN_TICKS) && !UART_TxIdle(); ticks++)
+      {
+        OS_TimeDelay(1);
+      }
+
+      BaudRateOld = UART_GetBaudRate();
+      if (!UART_SetBaudRate(BaudRateNew, CPU_BUS_CLK_HZ))
+      {
+        BaudRateState = BAUD_RATE_STEADY;
+        return 0;
+      }
+
+      BaudRateDeadline = OS_TimeGet() + BAUD_RATE_CONFIRM_TICKS;
+      BaudRateState = BAUD_RATE_CONFIRM;
+      return BAUD_RATE_CONFIRM_TICKS;
+
+    case BAUD_RATE_CONFIRM:
+      remaining = (int32_t)(BaudRateDeadline - OS_TimeGet());
+      if (remaining > 0)
+        return (uint32_t)remaining;
+
+      // The PC never made it to the new rate, so go back to where it can still reach us
+      (void)UART_SetBaudRate(BaudRateOld, CPU_BUS_CLK_HZ);
+      BaudRateState = BAUD_RATE_STEADY;
+      return 0;
 
-    // Send original command back with confirmation of success or failure.
-    Packet_Put
-    (
-      Packet_Command,
-      Packet_Parameter1,
-      Packet_Parameter2,
-      Packet_Parameter3
-    );
+    default:
+      return 0;
   }
 }
 
@@ -273,16 +396,23 @@ static void HandlePacket()
  */
 void Handle_PacketThread(void * pData)
 {
+  TPacket packet;
+  uint32_t timeout = 0;
+
   for (;;)
   {
-    OS_SemaphoreWait(Packet_ByteReady, 0);
+    // Only times out while a baud rate change is waiting to be confirmed
+    (void)OS_SemaphoreWait(Packet_ByteReady, timeout);
 
     if (InitSuccess)
     {
-      Packet_Get();
-      HandlePacket();
+      // Handle every packet that has arrived since the last wakeup
+      while (Packet_Get(&packet))
+      {
+        HandlePacket(&packet);
+      }
     }
+
+    timeout = BaudRateUpdate();
   }
 }
-
-
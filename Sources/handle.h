@@ -9,6 +9,11 @@
 #define SOURCES_HANDLE_H_
 
 #include "types.h"
+#include "packet.h"
+#include "Regulator.h"
+
+// Number of command table entries - one for every command byte without the acknowledge bit
+#define HANDLE_NB_COMMANDS 128
 
 typedef enum {
   COMMAND_TIMING_MODE = 0x10,
@@ -16,17 +21,35 @@ typedef enum {
   COMMAND_NB_LOWERS = 0x12,
   COMMAND_FREQUENCY = 0x17,
   COMMAND_VOLTAGE   = 0x18,
-  COMMAND_SPECTRUM  = 0x19
+  COMMAND_SPECTRUM  = 0x19,
+  COMMAND_SUBSCRIBE = 0x1A,
+  COMMAND_ALARM     = 0x1B,
+  COMMAND_PROTOCOL  = 0x1C,
+  COMMAND_STREAM    = 0x1D,
+  COMMAND_BAUD_RATE = 0x1E,
+  COMMAND_BENCHMARK = 0x1F,
+  COMMAND_STACK     = 0x20,
+  COMMAND_LOAD      = 0x21,
+  COMMAND_LATENCY   = 0x22,
+  COMMAND_EXECUTIVE = 0x23,
+  COMMAND_IDLE      = 0x24
 } PacketCommand_t;
 
 
-typedef enum
-{
-  DEFINITE,
-  INVERSE
-} TimerType;
-
+/*! @brief A command handler.
+ *
+ *  @param packet A pointer to the received packet.
+ *  @return bool - TRUE if the command was carried out successfully.
+ */
+typedef bool (*Handle_Command_t)(const TPacket* const packet);
 
+/*! @brief Registers the handler for a command, replacing any existing handler.
+ *
+ *  @param command The command byte, without the acknowledge bit.
+ *  @param handler The handler to call when the command is received, or NULL to ignore the command.
+ *  @return bool - TRUE if the handler was registered.
+ */
+bool Handle_Register(const uint8_t command, const Handle_Command_t handler);
 
 bool Handle_SendStartupPackets(void);
 
@@ -26,7 +26,7 @@
  */
 /* MODULE main */
 
-#include <Math.h>
+#include <math.h>
 // CPU module - contains low level hardware initialization routines
 #include "Cpu.h"
 
@@ -37,15 +37,26 @@
 #include "analog.h"
 // UART functions
 #include "FIFO.h"
-#include "Packet.h"
+#include "packet.h"
 #include "UART.h"
 #include "LEDs.h"
 #include "Flash.h"
 #include "PIT.h"
+#include "Acquisition.h"
 #include "RMS.h"
 #include "VRR.h"
+#include "Frequency.h"
+#include "Telemetry.h"
+#include "Stream.h"
+#include "DWT.h"
+#include "Benchmark.h"
+#include "Monitor.h"
+#include "StackSizes.h"
+#include "Executive.h"
+#include "Idle.h"
+#include "Regulator.h"
 #include "handle.h"
-extern OS_ECB* PITSemaphore;
+extern OS_ECB* PITSemaphores[PIT_NB_CHANNELS];
 
 
 //BAUD RATE
@@ -54,29 +65,54 @@ static const uint32_t BAUD_RATE = 115200;
 // ----------------------------------------
 // Thread set up
 // ----------------------------------------
-// Arbitrary thread stack size - big enough for stacking of interrupts and OS use.
-#define THREAD_STACK_SIZE 300
 #define NB_ANALOG_CHANNELS 3
 #define MAX_SAMPLE_SIZE 16
 
 
 #define SAMPLE_PERIOD 1250000
+#define SAMPLE_RATE (1000000000 / SAMPLE_PERIOD)
+
+// PIT channels, each running at its own period in ns - the acquisition has channels 1 and 3
+#define PIT_CHANNEL_TIMING       0
+#define PIT_CHANNEL_HOUSEKEEPING 2
+// Alarm timers advance every TIMING_PERIOD
+#define TIMING_PERIOD            10000000
+// Flash commits and telemetry pushes
+#define HOUSEKEEPING_PERIOD      100000000
+
+// Channel the frequency is measured on, and the number of cycles it is averaged over
+#define FREQUENCY_CHANNEL 0
+#define FREQUENCY_NB_CYCLES 4
 
 
 
 #define VOLT_PER_BIT 3276.7
 #define VOLT(x) 3277*(x)
 
-// Thread stacks
-OS_THREAD_STACK(InitModulesThreadStack, THREAD_STACK_SIZE); /*!< The stack for the LED Init thread. */
-OS_THREAD_STACK(UART_RecieveStack, THREAD_STACK_SIZE);
-OS_THREAD_STACK(UART_TransmitStack, THREAD_STACK_SIZE);
-OS_THREAD_STACK(Sample_Stack, THREAD_STACK_SIZE);
-OS_THREAD_STACK(SignalsOutput_Stack, THREAD_STACK_SIZE);
-OS_THREAD_STACK(HandlePacketStack, THREAD_STACK_SIZE);
-OS_THREAD_STACK(RMSThreadStack, THREAD_STACK_SIZE);
-
-static uint32_t AlarmThreadStacks[NB_ANALOG_CHANNELS][THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
+// Cyclic executive stage budgets - define CYCLIC_EXECUTIVE to run the measurement and regulation chain
+// as stages of one thread instead of a chain of threads. A cycle is one block, ACQUISITION_BLOCK_SAMPLES
+// samples or 10 ms. The sample stage takes 100 us a sample, plus 200 us for the window it streams every
+// other block; the window stage works out one window; the timing stage allows for the tick due and one
+// it is catching up on; the output stage updates the DAC. That is 1.4 ms, leaving over 85 % of the cycle
+// for comms and housekeeping.
+#define SAMPLE_BUDGET_US (ACQUISITION_BLOCK_SAMPLES * 100 + 200)
+#define WINDOW_BUDGET_US 200
+#define TIMING_BUDGET_US (2 * 50)
+#define OUTPUT_BUDGET_US 100
+#define EXECUTIVE_BUDGET(us) ((CPU_CORE_CLK_HZ / 1000000) * (us))
+
+// Thread stacks - sized in StackSizes.h
+OS_THREAD_STACK(InitModulesThreadStack, INIT_MODULES_STACK_SIZE); /*!< The stack for the LED Init thread. */
+OS_THREAD_STACK(Sample_Stack, SAMPLE_STACK_SIZE);
+OS_THREAD_STACK(HandlePacketStack, HANDLE_PACKET_STACK_SIZE);
+OS_THREAD_STACK(HousekeepingStack, HOUSEKEEPING_STACK_SIZE);
+OS_THREAD_STACK(IdleStack, IDLE_STACK_SIZE);
+#ifndef CYCLIC_EXECUTIVE
+OS_THREAD_STACK(SignalsOutput_Stack, SIGNAL_OUTPUT_STACK_SIZE);
+OS_THREAD_STACK(RMSThreadStack, RMS_STACK_SIZE);
+
+static uint32_t AlarmThreadStacks[NB_ANALOG_CHANNELS][ALARM_STACK_SIZE] __attribute__ ((aligned(0x08)));
+#endif
 
 // ----------------------------------------
 // Thread priorities
@@ -84,157 +120,286 @@ static uint32_t AlarmThreadStacks[NB_ANALOG_CHANNELS][THREAD_STACK_SIZE] __attri
 // ----------------------------------------
 
 static const uint16_t INIT_MODULES_THREAD_PRIORITY = 0;
-static const uint16_t UART_RECEIVE_THREAD_PRIORITY = 1;
-static const uint16_t UART_TRANSMIT_THREAD_PRIORITY = 7;
 static const uint16_t SAMPLE_THREAD_PRIORITY = 2;
-static const uint16_t SIGNALOUT_THREAD_PRIORITY = 8;
 static const uint16_t HANDLE_PACKET_THREAD_PRIORITY = 9;
+static const uint16_t HOUSEKEEPING_THREAD_PRIORITY = 10;
+#ifndef CYCLIC_EXECUTIVE
+static const uint16_t SIGNALOUT_THREAD_PRIORITY = 8;
 static const uint8_t RMS_THREAD_PRIORITY = 3;
 const uint8_t ALARM_THREAD_PRIORITIES[NB_ANALOG_CHANNELS] = {4,5,6};
+#endif
 
 
-/*! @brief Data structure used to pass Analog configuration to a user thread
+/*! @brief Data structure used to pass the channel to an alarm thread
  *
  */
-typedef struct RMSThreadData
-{
-  OS_ECB* semaphore;
-  uint8_t channelNb;
-  uint8_t sampleCount;
-
-} TRMSThreadData;
-
 typedef struct AlarmThreadData
 {
-  OS_ECB* voltageCheckSemaphore;
   OS_ECB* timeCountSemaphore;
-  int16_t sampleArray[MAX_SAMPLE_SIZE];
   uint8_t channelNb;
-  int16_t RMS;
-  bool voltageAlarm;
-  bool outofRange;
-  bool raiseRequest;
-  bool lowerRequest;
-  bool raiseSignal;
-  bool lowerSignal;
-  uint64_t TimerDelay;
-  uint64_t TimerCount;
-  //Change to Enum list
-
 } TAlarmThreadData;
 
-/*! @brief Analog thread configuration data
+/*! @brief Alarm thread configuration data
  *
  */
-
- TAlarmThreadData AlarmThreadData[NB_ANALOG_CHANNELS] =
+TAlarmThreadData AlarmThreadData[NB_ANALOG_CHANNELS] =
 {
   {
-    .voltageCheckSemaphore = NULL,
-    .channelNb = 0,
-    .RMS = 0,
-    .voltageAlarm = false,
-    .TimerCount = 0
-
+    .timeCountSemaphore = NULL,
+    .channelNb = 0
   },
   {
-    .voltageCheckSemaphore = NULL,
-    .channelNb = 1,
-    .RMS = 0,
-    .voltageAlarm = false,
-    .TimerCount = 0
+    .timeCountSemaphore = NULL,
+    .channelNb = 1
   },
   {
-    .voltageCheckSemaphore = NULL,
-    .channelNb = 2,
-    .RMS = 0,
-    .voltageAlarm = false,
-    .TimerCount = 0
+    .timeCountSemaphore = NULL,
+    .channelNb = 2
   }
 };
 
+// The regulation pipeline - the threads below decide when each of its stages runs
+TRegulator Regulator;
+
+TFrequencyEstimator FrequencyEstimator;
 
 OS_ECB* SignalOutputSemaphore;
-OS_ECB* PITCountSemaphore;
 OS_ECB* RMSCalcSemaphore;
 
-static uint64_t inverseTimerDelay[3];
-bool OutofRange = false;
-
-static uint64_t counter = 0;
-
 bool InitSuccess = false;
 
 extern TimerType Mode;
-extern uint16union_t * NbRaises = 0;
-uint8_t NbRaisesCount = 0;
-extern uint16union_t * NbLowers = 0;
-uint8_t NbLowersCount = 0;
+uint16union_t * NbRaises = 0;
+uint16_t NbRaisesCount = 0;
+uint16union_t * NbLowers = 0;
+uint16_t NbLowersCount = 0;
 
 
-/*! @brief Initialises modules.
+/*! @brief Adds a block of samples of the inputs to the window.
  *
+ *  @param block The block, sampled on the PIT by the acquisition.
+ *  @return bool - TRUE if the window is complete.
  */
-static void InitModulesThread(void* pData)
+static bool SampleInputs(const TAcquisitionBlock* const block)
 {
+  bool complete = false;
 
-  OS_DisableInterrupts();
+  for (uint8_t sampleNb = 0; sampleNb < ACQUISITION_BLOCK_SAMPLES; sampleNb++)
+  {
+    Frequency_Update(&FrequencyEstimator, block->samples[sampleNb].values[FREQUENCY_CHANNEL]);
+    if (Regulator_Sample(&Regulator, block->samples[sampleNb].values))
+      complete = true;
+  }
 
-  while (!InitSuccess)
+  if (complete)
   {
-    InitSuccess = true;
-    InitSuccess &= Packet_Init(BAUD_RATE, CPU_BUS_CLK_HZ);
-    InitSuccess &= Flash_Init();
-    InitSuccess &= LEDs_Init();
-    InitSuccess &= PIT_Init(CPU_BUS_CLK_HZ, NULL, NULL);
-    InitSuccess &= Analog_Init(CPU_BUS_CLK_HZ);
+    // Streamed straight from the window, a sample of every channel together
+    const int16_t (* const window)[NB_ANALOG_CHANNELS] = Regulator.windows[Regulator.complete];
+
+    (void)Stream_Window(window[0], NB_ANALOG_CHANNELS, MAX_SAMPLE_SIZE, NB_ANALOG_CHANNELS);
   }
 
-  // Generate the global analog semaphores
-  for (uint8_t analogNb = 0; analogNb < NB_ANALOG_CHANNELS; analogNb++)
+  return complete;
+}
+
+/*! @brief Works out the RMS of a complete window and publishes it.
+ *
+ */
+static void ProcessWindow(void)
+{
+  if (!Regulator_Window(&Regulator, Mode))
   {
-    //check voltage & deviation when out of range voltage detected
-    AlarmThreadData[analogNb].voltageCheckSemaphore = OS_SemaphoreCreate(0);
-    //ticks the counter
-    AlarmThreadData[analogNb].timeCountSemaphore = OS_SemaphoreCreate(0);
+    Monitor_LatencyOverrun();
+    return;
   }
 
-  SignalOutputSemaphore = OS_SemaphoreCreate(0);
-  //Signals Timer for definite and inverse timing
-  PITCountSemaphore     = OS_SemaphoreCreate(0);
-  //Signals RMS Calculations
-  RMSCalcSemaphore      = OS_SemaphoreCreate(0);
+  // Make the new window available to COMMAND_VOLTAGE
+  RMS_Publish(Regulator.rms);
+}
 
-  PIT_Set(SAMPLE_PERIOD, true);
-  OS_EnableInterrupts();
+/*! @brief Pushes the subscribed measurements that are due.
+ *
+ */
+static void PushTelemetry(void)
+{
+  uint16_t telemetry[TELEMETRY_NB_SOURCES];
 
-  // We only do this once - therefore delete this thread
-  OS_ThreadDelete(OS_PRIORITY_SELF);
+  for (int channelNb = 0; channelNb < NB_ANALOG_CHANNELS; channelNb++)
+  {
+    telemetry[TELEMETRY_RMS_0 + channelNb] = Regulator.rms[channelNb];
+  }
+  telemetry[TELEMETRY_FREQUENCY] = Frequency_Get(&FrequencyEstimator);
+  telemetry[TELEMETRY_NB_RAISES] = Regulator.nbRaises;
+  telemetry[TELEMETRY_NB_LOWERS] = Regulator.nbLowers;
+  telemetry[TELEMETRY_ALARMS] = (Regulator.status & REGULATOR_STATUS_FIELD(REGULATOR_STATUS_ALARM)) >> REGULATOR_STATUS_ALARM;
+  Telemetry_Update(telemetry);
 }
 
-void Sample_Thread(void* pData)
+/*! @brief Drives the raise, lower and alarm outputs.
+ *
+ */
+static void UpdateOutputs(void)
 {
-  //TODO: Change PIT to 3 channel period
-  for (;;)
+  int16_t outputs[REGULATOR_NB_OUTPUTS];
+
+  Regulator_Outputs(&Regulator, outputs);
+
+  // The DAC shares the SPI with the acquisition
+  Acquisition_Hold(true);
+  for (uint8_t outputNb = 0; outputNb < REGULATOR_NB_OUTPUTS; outputNb++)
   {
-    static uint8_t sampleCount = 0;
-    (void)OS_SemaphoreWait(PITSemaphore,0);
+    Analog_Put(outputNb, outputs[outputNb]);
+  }
+  Acquisition_Hold(false);
+}
 
-    for (int channelNb =0; channelNb< NB_ANALOG_CHANNELS; channelNb++)
-    {
-      Analog_Get(channelNb, &(AlarmThreadData[channelNb].sampleArray[sampleCount]));
-    }
-    sampleCount ++;
+/*! @brief Starts a tap change count from the one kept in flash.
+ *
+ *  @param stored The count in flash, which reads 0xFFFF until it is first written.
+ *  @return uint16_t - The count to carry on from.
+ */
+static uint16_t LoadTapCount(uint16union_t* const stored)
+{
+  // Written as 0 so COMMAND_NB_RAISES and COMMAND_NB_LOWERS agree with the telemetry from the start
+  if (stored->l == 0xFFFF)
+    (void)Flash_Write16(&stored->l, 0);
+
+  return stored->l;
+}
+
+/*! @brief Keeps the tap change counts across power cycles.
+ *
+ */
+static void SaveTapCounts(void)
+{
+  if (NbRaisesCount != Regulator.nbRaises)
+  {
+    NbRaisesCount = Regulator.nbRaises;
+    Flash_Write16((volatile uint16_t*)NbRaises, NbRaisesCount);
+  }
+
+  if (NbLowersCount != Regulator.nbLowers)
+  {
+    NbLowersCount = Regulator.nbLowers;
+    Flash_Write16((volatile uint16_t*)NbLowers, NbLowersCount);
+  }
+}
+
+#ifdef CYCLIC_EXECUTIVE
+
+// The block the cycle is for
+static TAcquisitionBlock Acquired;
+
+// Set by one stage for the ones after it in the same cycle
+static bool WindowReady;
+static bool OutputsDue;
+
+// Timing periods that have passed since the timing stage last ran
+static volatile uint8_t TimingTicks;
+
+/*! @brief Counts a timing period for the timing stage.
+ *
+ *  @note The timing PIT channel's callback.
+ */
+static void TimingTick(void* pData)
+{
+  TimingTicks++;
+}
+
+static void SampleStage(void)
+{
+  WindowReady = SampleInputs(&Acquired);
+}
+
+static void WindowStage(void)
+{
+  if (WindowReady)
+  {
+    ProcessWindow();
+    // The alarm output follows the window
+    OutputsDue = true;
+  }
+}
+
+static void TimingStage(void)
+{
+  uint8_t ticks;
 
-    if(sampleCount > 15)
+  OS_DisableInterrupts();
+  ticks = TimingTicks;
+  TimingTicks = 0;
+  OS_EnableInterrupts();
+
+  for (; ticks > 0; ticks--)
+  {
+    for (uint8_t channelNb = 0; channelNb < NB_ANALOG_CHANNELS; channelNb++)
     {
-      sampleCount = 0;
-      OS_SemaphoreSignal(RMSCalcSemaphore);
+      if (Regulator_Timing(&Regulator, channelNb))
+        OutputsDue = true;
     }
+  }
+}
+
+static void OutputStage(void)
+{
+  if (!OutputsDue)
+    return;
+
+  OutputsDue = false;
+  UpdateOutputs();
+}
+
+// The stages of every block, in order
+static const TExecutiveStage Stages[] =
+{
+  {SampleStage, EXECUTIVE_BUDGET(SAMPLE_BUDGET_US)},
+  {WindowStage, EXECUTIVE_BUDGET(WINDOW_BUDGET_US)},
+  {TimingStage, EXECUTIVE_BUDGET(TIMING_BUDGET_US)},
+  {OutputStage, EXECUTIVE_BUDGET(OUTPUT_BUDGET_US)}
+};
+
+/*! @brief Runs the measurement and regulation chain once per block.
+ *
+ */
+void Executive_Thread(void* pData)
+{
+  for (;;)
+  {
+    if (!Acquisition_GetBlock(&Acquired))
+      Monitor_LatencyDropped(Acquired.dropped);
+    Monitor_LatencyEnd();
+
+    (void)Executive_Run();
+  }
+}
 
-    for (int channelNb =0; channelNb < NB_ANALOG_CHANNELS; channelNb++)
+#else
+
+/*! @brief Starts a timing period in every alarm thread.
+ *
+ *  @note The timing PIT channel's callback.
+ */
+static void TimingTick(void* pData)
+{
+  for (int channelNb =0; channelNb < NB_ANALOG_CHANNELS; channelNb++)
+  {
+    OS_SemaphoreSignal(AlarmThreadData[channelNb].timeCountSemaphore);
+  }
+}
+
+void Sample_Thread(void* pData)
+{
+  TAcquisitionBlock block;
+
+  for (;;)
+  {
+    if (!Acquisition_GetBlock(&block))
+      Monitor_LatencyDropped(block.dropped);
+    Monitor_LatencyEnd();
+
+    if (SampleInputs(&block))
     {
-      OS_SemaphoreSignal(AlarmThreadData[channelNb].timeCountSemaphore);
+      OS_SemaphoreSignal(RMSCalcSemaphore);
     }
   }
 
@@ -247,41 +412,11 @@ void RMS_CalcThread (void* pData)
   for (;;)
   {
     OS_SemaphoreWait(RMSCalcSemaphore, 0);
-    int16_t RMSTest[3];
-    int16_t VoltageDeviate[3];
 
-    for (int channelNb = 0; channelNb < NB_ANALOG_CHANNELS; channelNb++)
-    {
-      RMSTest[channelNb] = RMS_Calculate(AlarmThreadData[channelNb].sampleArray, MAX_SAMPLE_SIZE);
-      AlarmThreadData[channelNb].RMS = RMSTest[channelNb];
-      VoltageDeviate[channelNb] = VRR_CalcDeviation(RMSTest[channelNb]);
-      //Change calculation to nanoseconds if neccesaary
-      inverseTimerDelay[channelNb] = (uint64_t)((5E-9*VOLT(0.5))/VoltageDeviate[channelNb]);
-    }
-
-    for (int channelNb = 0; channelNb < NB_ANALOG_CHANNELS; channelNb++)
-    {
-      if (RMSTest[channelNb] < VOLT(2) || RMSTest[channelNb] > VOLT(3))
-      {
-        AlarmThreadData[channelNb].voltageAlarm = true;
-        OS_SemaphoreSignal(SignalOutputSemaphore);
-        Analog_Put(2, VOLT(5));
-        // signal Functionality not working so added analog_put to show logic
-        OS_SemaphoreSignal(AlarmThreadData[channelNb].voltageCheckSemaphore);
-      }
-      else
-      {
-        Analog_Put(2, VOLT(0));
-        Analog_Put(1, VOLT(0));
-        Analog_Put(0, VOLT(0));
-        // signal Functionality not working so added analog_put to show logic
-        AlarmThreadData[channelNb].voltageAlarm = false;
-        AlarmThreadData[channelNb].lowerRequest = false;
-        AlarmThreadData[channelNb].raiseRequest = false;
-        OS_SemaphoreSignal(SignalOutputSemaphore);
-      }
-    }
+    ProcessWindow();
 
+    // The alarm output follows the window
+    OS_SemaphoreSignal(SignalOutputSemaphore);
   }
 }
 
@@ -289,90 +424,16 @@ void Alarm_Thread (void* pData)
 {
   #define alarmData ((TAlarmThreadData*)pData)
 
-  int16_t RMS = 0;
-  uint64_t i;
-  uint64_t inverseWaitTime;
   for (;;)
   {
-    OS_SemaphoreWait(alarmData->voltageCheckSemaphore, 0);
-    alarmData->outofRange = true;
-    RMS = alarmData->RMS;
-    uint16_t VoltageDeviate;
+    // One timing period has passed
+    OS_SemaphoreWait(alarmData->timeCountSemaphore, 0);
 
-    switch(Mode)
+    if (Regulator_Timing(&Regulator, alarmData->channelNb))
     {
-      case DEFINITE:
-        for (i =0; i < 5e-9; i+= 1250000)
-        {
-          if (alarmData->RMS <= VOLT(3) && alarmData->RMS >= VOLT(2))
-          {
-            alarmData->lowerRequest = false;
-            alarmData->voltageAlarm = false;
-            alarmData->raiseRequest = false;
-            break;
-          }
-          OS_SemaphoreWait(alarmData->timeCountSemaphore, 0);
-        }
-
-        if (alarmData->RMS < VOLT(2))
-        {
-          alarmData->raiseRequest = true;
-          Analog_Put(0, VOLT(5));
-          // signal Functionality not working so added analog_put to show logic
-          OS_SemaphoreSignal(SignalOutputSemaphore);
-        }
-
-        if (alarmData->RMS > VOLT(3))
-        {
-          alarmData->lowerRequest = true;
-          Analog_Put(1, VOLT(5));
-          // signal Functionality not working so added analog_put to show logic
-          OS_SemaphoreSignal(SignalOutputSemaphore);
-        }
-
-      case INVERSE:
-
-        alarmData->TimerDelay = inverseTimerDelay[alarmData->channelNb];
-        OutofRange = true;
-
-        VoltageDeviate = VRR_CalcDeviation(alarmData->RMS);
-        inverseWaitTime = (uint64_t)((5E-9*VOLT(0.5))/VoltageDeviate);
-
-        for (int i =0; i< inverseWaitTime ; i+= 1250000)
-        {
-          if (alarmData->RMS <= VOLT(3) && alarmData->RMS >= VOLT(2))
-          {
-            alarmData->voltageAlarm = false;
-            alarmData->lowerRequest = false;
-            alarmData->raiseRequest = false;
-            break;
-          }
-
-          alarmData->RMS = RMS_Calculate(alarmData->sampleArray, MAX_SAMPLE_SIZE);
-          VoltageDeviate = VRR_CalcDeviation(alarmData->RMS);
-          inverseWaitTime = (uint64_t)((5E-9*VOLT(0.5))/VoltageDeviate);
-
-          OS_SemaphoreWait(PITCountSemaphore, 0);
-
-        }
-
-        if (alarmData->RMS < VOLT(2))
-            {
-              alarmData->raiseRequest = true;
-              Analog_Put(0, VOLT(5));
-              // signal Functionality not working so added analog_put to show logic
-              OS_SemaphoreSignal(SignalOutputSemaphore);
-            }
-
-            if (alarmData->RMS > VOLT(3))
-            {
-              alarmData->lowerRequest = true;
-              Analog_Put(1, VOLT(5));
-              // signal Functionality not working so added analog_put to show logic
-              OS_SemaphoreSignal(SignalOutputSemaphore);
-            }
-      }
+      OS_SemaphoreSignal(SignalOutputSemaphore);
     }
+  }
 
 }
 
@@ -383,117 +444,169 @@ void SignalOutput_Thread(void* pData)
 {
   for (;;)
   {
-    LEDs_Off(LED_BLUE);
-    LEDs_Off(LED_GREEN);
-    LEDs_Off(LED_ORANGE);
-    LEDs_Off(LED_YELLOW);
     OS_SemaphoreWait(SignalOutputSemaphore,0);
 
-    for (int channelNb = 0; channelNb <NB_ANALOG_CHANNELS ; channelNb++)
-    {
+    UpdateOutputs();
+  }
 
-      if (AlarmThreadData[channelNb].voltageAlarm)
-      {
-        //TODO: 0 to Channel 1
-        Analog_Put(2, VOLT(5));
-//        LEDs_On(LED_GREEN);
-      }
-      else
-      {
-        Analog_Put(2, VOLT(0));
-      }
-
-      if (AlarmThreadData[channelNb].raiseRequest)
-      {
-        Analog_Put(1, VOLT(5));
-        Flash_AllocateVar(&NbRaises,1);
-        NbRaisesCount ++;
-        Flash_Write16(NbRaises, NbRaisesCount);
-      }
-      else
-      {
-        Analog_Put(1, VOLT(0));
-      }
-
-      if (AlarmThreadData[channelNb].lowerRequest)
-      {
-        Analog_Put(0, VOLT(5));
-        Flash_AllocateVar(&NbLowers,1);
-        NbLowersCount ++;
-        Flash_Write16(NbLowers, NbLowers);
-      }
-      else
-      {
-        Analog_Put(0, VOLT(0));
-      }
+}
 
-    }
+#endif
 
+/*! @brief Does the slow work - flash commits and telemetry pushes - once per housekeeping period.
+ *
+ */
+void Housekeeping_Thread(void* pData)
+{
+  for (;;)
+  {
+    (void)OS_SemaphoreWait(PITSemaphores[PIT_CHANNEL_HOUSEKEEPING], 0);
 
+    SaveTapCounts();
+    PushTelemetry();
   }
-
 }
 
 
 
+/*! @brief Initialises modules.
+ *
+ */
+static void InitModulesThread(void* pData)
+{
+
+  OS_DisableInterrupts();
+
+  while (!InitSuccess)
+  {
+    InitSuccess = true;
+    InitSuccess &= Packet_Init(BAUD_RATE, CPU_BUS_CLK_HZ);
+    InitSuccess &= Flash_Init();
+    InitSuccess &= LEDs_Init();
+    InitSuccess &= PIT_Init(CPU_BUS_CLK_HZ);
+    InitSuccess &= PIT_ChannelInit(PIT_CHANNEL_TIMING, TimingTick, NULL);
+    InitSuccess &= PIT_ChannelInit(PIT_CHANNEL_HOUSEKEEPING, NULL, NULL);
+    InitSuccess &= Analog_Init(CPU_BUS_CLK_HZ);
+    InitSuccess &= Acquisition_Init(CPU_BUS_CLK_HZ, Monitor_LatencyStart, NULL);
+    InitSuccess &= Regulator_Init(&Regulator, TIMING_PERIOD);
+    InitSuccess &= Frequency_Init(&FrequencyEstimator, SAMPLE_RATE, FREQUENCY_NB_CYCLES);
+    InitSuccess &= Telemetry_Init();
+    InitSuccess &= Stream_Init();
+    InitSuccess &= DWT_Init();
+    InitSuccess &= Benchmark_Init(DWT_CycleCount);
+    InitSuccess &= Monitor_Init();
+    InitSuccess &= Idle_Init();
+#ifdef CYCLIC_EXECUTIVE
+    InitSuccess &= Executive_Init(Stages, sizeof(Stages) / sizeof(Stages[0]));
+#endif
+  }
+
+  // Non-volatile tap change counts, carried on from before the power cycle
+  if (Flash_AllocateVar((volatile void**)&NbRaises, sizeof(uint16_t)))
+    NbRaisesCount = LoadTapCount(NbRaises);
+  if (Flash_AllocateVar((volatile void**)&NbLowers, sizeof(uint16_t)))
+    NbLowersCount = LoadTapCount(NbLowers);
+  Regulator.nbRaises = NbRaisesCount;
+  Regulator.nbLowers = NbLowersCount;
+
+#ifndef CYCLIC_EXECUTIVE
+  SignalOutputSemaphore = OS_SemaphoreCreate(0);
+
+  // Generate the global analog semaphores
+  for (uint8_t analogNb = 0; analogNb < NB_ANALOG_CHANNELS; analogNb++)
+  {
+    //ticks the alarm timer
+    AlarmThreadData[analogNb].timeCountSemaphore = OS_SemaphoreCreate(0);
+  }
+
+  //Signals RMS Calculations
+  RMSCalcSemaphore      = OS_SemaphoreCreate(0);
+#endif
+
+  Acquisition_Start(SAMPLE_PERIOD);
+  PIT_Set(PIT_CHANNEL_TIMING, TIMING_PERIOD, true);
+  PIT_Set(PIT_CHANNEL_HOUSEKEEPING, HOUSEKEEPING_PERIOD, true);
+  OS_EnableInterrupts();
+
+  // We only do this once - therefore delete this thread
+  OS_ThreadDelete(OS_PRIORITY_SELF);
+}
+
 /*lint -save  -e970 Disable MISRA rule (6.3) checking. */
 int main(void)
 /*lint -restore Enable MISRA rule (6.3) checking. */
 {
-  OS_ERROR error;
-
   // Initialise low-level clocks etc using Processor Expert code
    PE_low_level_init();
 
   // Initialize the RTOS
   OS_Init(CPU_CORE_CLK_HZ, true);
 
-  // Create module initialisation thread
-  error = OS_ThreadCreate(InitModulesThread,
-                          NULL,
-                          &InitModulesThreadStack[THREAD_STACK_SIZE - 1],
-                          INIT_MODULES_THREAD_PRIORITY); // Highest priority
-
-  error = OS_ThreadCreate(UART_ReceiveThread,
-                          NULL,
-                          &UART_RecieveStack[THREAD_STACK_SIZE-1],
-                          UART_RECEIVE_THREAD_PRIORITY);
-
-  error = OS_ThreadCreate(UART_TransmitThread,
-                          NULL,
-                          &UART_TransmitStack[THREAD_STACK_SIZE-1],
-                          UART_TRANSMIT_THREAD_PRIORITY);
-
-  error = OS_ThreadCreate(Handle_PacketThread,
-                          NULL,
-                          &HandlePacketStack[THREAD_STACK_SIZE-1],
-                          HANDLE_PACKET_THREAD_PRIORITY);
-
-  error = OS_ThreadCreate(Sample_Thread,
-                          NULL,
-                          &Sample_Stack[THREAD_STACK_SIZE-1],
-                          SAMPLE_THREAD_PRIORITY );
-
-  error = OS_ThreadCreate(SignalOutput_Thread,
-                          NULL,
-                          &SignalsOutput_Stack[THREAD_STACK_SIZE-1],
-                          SIGNALOUT_THREAD_PRIORITY );
-
-  error = OS_ThreadCreate(RMS_CalcThread,
-                          NULL,
-                          &RMSThreadStack[THREAD_STACK_SIZE - 1],
-                          RMS_THREAD_PRIORITY );
+  // Create module initialisation thread - the stacks are painted so their high water marks can be read
+  (void)Monitor_ThreadCreate(InitModulesThread,
+                             NULL,
+                             InitModulesThreadStack,
+                             INIT_MODULES_STACK_SIZE,
+                             INIT_MODULES_THREAD_PRIORITY); // Highest priority
+
+  (void)Monitor_ThreadCreate(Handle_PacketThread,
+                             NULL,
+                             HandlePacketStack,
+                             HANDLE_PACKET_STACK_SIZE,
+                             HANDLE_PACKET_THREAD_PRIORITY);
+
+  // Sleeps between interrupts - not monitored, so its time counts as idle
+  (void)OS_ThreadCreate(Idle_Thread,
+                        NULL,
+                        &IdleStack[IDLE_STACK_SIZE - 1],
+                        IDLE_THREAD_PRIORITY);
+
+#ifdef CYCLIC_EXECUTIVE
+  // The whole measurement and regulation chain runs in the sampling thread's place
+  (void)Monitor_ThreadCreate(Executive_Thread,
+                             NULL,
+                             Sample_Stack,
+                             SAMPLE_STACK_SIZE,
+                             SAMPLE_THREAD_PRIORITY );
+#else
+  (void)Monitor_ThreadCreate(Sample_Thread,
+                             NULL,
+                             Sample_Stack,
+                             SAMPLE_STACK_SIZE,
+                             SAMPLE_THREAD_PRIORITY );
+#endif
+
+  (void)Monitor_ThreadCreate(Housekeeping_Thread,
+                             NULL,
+                             HousekeepingStack,
+                             HOUSEKEEPING_STACK_SIZE,
+                             HOUSEKEEPING_THREAD_PRIORITY);
+
+#ifndef CYCLIC_EXECUTIVE
+  (void)Monitor_ThreadCreate(SignalOutput_Thread,
+                             NULL,
+                             SignalsOutput_Stack,
+                             SIGNAL_OUTPUT_STACK_SIZE,
+                             SIGNALOUT_THREAD_PRIORITY );
+
+  (void)Monitor_ThreadCreate(RMS_CalcThread,
+                             NULL,
+                             RMSThreadStack,
+                             RMS_STACK_SIZE,
+                             RMS_THREAD_PRIORITY );
 
 // --------------------------------------------------------------------------------------------------------------
 
   // Create threads for analog loopback channels
   for (uint8_t threadNb = 0; threadNb < NB_ANALOG_CHANNELS; threadNb++)
   {
-    error = OS_ThreadCreate(Alarm_Thread,
-                            &AlarmThreadData[threadNb],
-                            &AlarmThreadStacks[threadNb][THREAD_STACK_SIZE-1],
-                            ALARM_THREAD_PRIORITIES[threadNb]);
+    (void)Monitor_ThreadCreate(Alarm_Thread,
+                               &AlarmThreadData[threadNb],
+                               AlarmThreadStacks[threadNb],
+                               ALARM_STACK_SIZE,
+                               ALARM_THREAD_PRIORITIES[threadNb]);
   }
+#endif
 
   // Start multithreading - never returns!
   OS_Start();
@@ -18,17 +18,55 @@
 
 #include "UART.h"
 #include "FIFO.h"
+#include "CRC.h"
 #include "packet.h"
 
 
 #define PACKET_SIZE_BYTES 5
 
-const uint8_t PACKET_ACK_MASK = 0b10000000;
+// Number of bulk frames that can be in flight at once
+#define NB_FRAME_BUFFERS 2
+
+// Extended frame parser states
+enum
+{
+  FRAME_STATE_MARKER,
+  FRAME_STATE_COMMAND,
+  FRAME_STATE_LENGTH_LO,
+  FRAME_STATE_LENGTH_HI,
+  FRAME_STATE_PAYLOAD,
+  FRAME_STATE_CRC_LO,
+  FRAME_STATE_CRC_HI
+};
 
-TPacket Packet;
+const uint8_t PACKET_ACK_MASK = 0b10000000;
 
 OS_ECB* Packet_ByteReady;
 
+// Parsers for the bytes coming in from the UART
+static TPacketParser Parser;
+static TFrameParser FrameParser;
+
+// Framing of the current session
+static volatile TPacketProtocol Protocol;
+
+/*!
+ * @struct FrameBuffer_t
+ * @brief A bulk frame being sent by DMA.
+ */
+typedef struct
+{
+  volatile bool busy;                       /*!< TRUE until the frame has been sent */
+  uint8_t bytes[PACKET_FRAME_MAX_SIZE];     /*!< The frame */
+} FrameBuffer_t;
+
+static FrameBuffer_t FrameBuffers[NB_FRAME_BUFFERS];
+
+// Validated packets waiting for Packet_Get - only touched by the thread calling Packet_Get
+static TPacket PacketQueue[PACKET_QUEUE_SIZE];
+static uint8_t QueueHead;
+static uint8_t QueueTail;
+
 bool Packet_Init(const uint32_t baudRate, const uint32_t moduleClk)
 {
   Packet_ByteReady = OS_SemaphoreCreate(0);
@@ -36,54 +74,286 @@ bool Packet_Init(const uint32_t baudRate, const uint32_t moduleClk)
   if (hasInitialized)
     return false;
 
+  Packet_ParserInit(&Parser);
+  Packet_FrameParserInit(&FrameParser);
+  Protocol = PACKET_PROTOCOL_LEGACY;
+  QueueHead = 0;
+  QueueTail = 0;
+
   // Set Packet to initialized if UART initialized and return
   return (hasInitialized = UART_Init(baudRate, moduleClk));
 }
 
-void Packet_Get()
+void Packet_ParserInit(TPacketParser* const parser)
 {
-  static uint8_t packet[5];
-  static uint8_t count = 0;
-  for (;;)
+  parser->oldest = 0;
+  parser->count = 0;
+  parser->checksum = 0;
+}
+
+bool Packet_ParserFeed(TPacketParser* const parser, const uint8_t data, TPacket* const packet)
+{
+  uint8_t slot;
+
+  if (parser->count < PACKET_NB_BYTES)
   {
-    UART_InChar(&packet[count]);
-    if (count == 4)
-    {
-      if (packet[4] == packet[0]^packet[1]^packet[2]^packet[3])
+    slot = parser->oldest + parser->count;
+    if (slot >= PACKET_NB_BYTES)
+      slot -= PACKET_NB_BYTES;
+    parser->count++;
+  }
+  else
+  {
+    // Window is full, so resync by dropping the oldest byte and its share of the checksum
+    slot = parser->oldest;
+    parser->checksum ^= parser->window[slot];
+    parser->oldest++;
+    if (parser->oldest >= PACKET_NB_BYTES)
+      parser->oldest = 0;
+  }
+
+  parser->window[slot] = data;
+  parser->checksum ^= data;
+
+  // The checksum byte is the XOR of the other four, so a valid packet XORs to zero
+  if ((parser->count < PACKET_NB_BYTES) || (parser->checksum != 0))
+    return false;
+
+  slot = parser->oldest;
+  for (uint8_t i = 0; i < PACKET_NB_BYTES; i++)
+  {
+    packet->bytes[i] = parser->window[slot];
+    if (++slot >= PACKET_NB_BYTES)
+      slot = 0;
+  }
+
+  Packet_ParserInit(parser);
+
+  return true;
+}
+
+void Packet_FrameParserInit(TFrameParser* const parser)
+{
+  parser->state = FRAME_STATE_MARKER;
+}
+
+bool Packet_FrameParserFeed(TFrameParser* const parser, const uint8_t data, TPacket* const packet)
+{
+  switch (parser->state)
+  {
+    case FRAME_STATE_MARKER:
+      if (data == PACKET_FRAME_MARKER)
       {
-	Packet_Command    = packet[0];
-	Packet_Parameter1 = packet[1];
-	Packet_Parameter2 = packet[2];
-	Packet_Parameter3 = packet[3];
-	Packet_Checksum   = packet[4];
-	count = 0;
-
-	return;
+        parser->crc = CRC_16_INIT;
+        parser->state = FRAME_STATE_COMMAND;
       }
+      return false;
+
+    case FRAME_STATE_COMMAND:
+      parser->command = data;
+      parser->crc = CRC_Update16(parser->crc, data);
+      parser->state = FRAME_STATE_LENGTH_LO;
+      return false;
+
+    case FRAME_STATE_LENGTH_LO:
+      parser->length = data;
+      parser->crc = CRC_Update16(parser->crc, data);
+      parser->state = FRAME_STATE_LENGTH_HI;
+      return false;
+
+    case FRAME_STATE_LENGTH_HI:
+      parser->length |= (uint16_t)data << 8;
+      parser->crc = CRC_Update16(parser->crc, data);
+      parser->count = 0;
+      // An impossible length means this was not really a marker, so resync straight away
+      if (parser->length > PACKET_FRAME_MAX_PAYLOAD)
+        parser->state = FRAME_STATE_MARKER;
       else
-      {
-        packet[0] = packet[1];
-        packet[1] = packet[2];
-	packet[2] = packet[3];
-	packet[3] = packet[4];
-	count--;
-      }
+        parser->state = (parser->length == 0) ? FRAME_STATE_CRC_LO : FRAME_STATE_PAYLOAD;
+      return false;
+
+    case FRAME_STATE_PAYLOAD:
+      if (parser->count < PACKET_FRAME_COMMAND_PAYLOAD)
+        parser->payload[parser->count] = data;
+      parser->crc = CRC_Update16(parser->crc, data);
+      if (++parser->count == parser->length)
+        parser->state = FRAME_STATE_CRC_LO;
+      return false;
+
+    case FRAME_STATE_CRC_LO:
+      parser->crc ^= data;
+      parser->state = FRAME_STATE_CRC_HI;
+      return false;
+
+    case FRAME_STATE_CRC_HI:
+      parser->state = FRAME_STATE_MARKER;
+      parser->crc ^= (uint16_t)data << 8;
+      if ((parser->crc != 0) || (parser->length != PACKET_FRAME_COMMAND_PAYLOAD))
+        return false;
+
+      packet->bytes[0] = parser->command;
+      packet->bytes[1] = parser->payload[0];
+      packet->bytes[2] = parser->payload[1];
+      packet->bytes[3] = parser->payload[2];
+      packet->bytes[4] = parser->command ^ parser->payload[0] ^ parser->payload[1] ^ parser->payload[2];
+      return true;
+
+    default:
+      parser->state = FRAME_STATE_MARKER;
+      return false;
+  }
+}
+
+bool Packet_SetProtocol(const TPacketProtocol protocol)
+{
+  if ((protocol != PACKET_PROTOCOL_LEGACY) && (protocol != PACKET_PROTOCOL_EXTENDED))
+    return false;
+
+  Packet_ParserInit(&Parser);
+  Packet_FrameParserInit(&FrameParser);
+  Protocol = protocol;
+
+  return true;
+}
+
+TPacketProtocol Packet_GetProtocol(void)
+{
+  return Protocol;
+}
+
+uint16_t Packet_FrameSeal(uint8_t* const frame, const uint8_t command, const uint16_t length)
+{
+  uint16_t crc;
+
+  if (length > PACKET_FRAME_MAX_PAYLOAD)
+    return 0;
+
+  frame[0] = PACKET_FRAME_MARKER;
+  frame[1] = command;
+  frame[2] = (uint8_t)length;
+  frame[3] = (uint8_t)(length >> 8);
+
+  crc = CRC_Calculate16(CRC_16_INIT, &frame[1], PACKET_FRAME_HEADER_SIZE - 1 + length);
+  frame[PACKET_FRAME_HEADER_SIZE + length] = (uint8_t)crc;
+  frame[PACKET_FRAME_HEADER_SIZE + length + 1] = (uint8_t)(crc >> 8);
+
+  return PACKET_FRAME_HEADER_SIZE + length + PACKET_FRAME_TRAILER_SIZE;
+}
+
+bool Packet_PutFrame(const uint8_t command, const uint8_t* const payload, const uint16_t length)
+{
+  FrameBuffer_t* buffer = NULL;
+  uint16_t size;
+
+  if ((Protocol != PACKET_PROTOCOL_EXTENDED) || (length > PACKET_FRAME_MAX_PAYLOAD))
+    return false;
+
+  // Claim a free buffer - it stays busy until the DMA has sent it
+  EnterCritical();
+  for (uint8_t i = 0; i < NB_FRAME_BUFFERS; i++)
+  {
+    if (!FrameBuffers[i].busy)
+    {
+      buffer = &FrameBuffers[i];
+      buffer->busy = true;
+      break;
     }
-    count++;
   }
+  ExitCritical();
+
+  if (!buffer)
+    return false;
+
+  for (uint16_t i = 0; i < length; i++)
+    buffer->bytes[PACKET_FRAME_HEADER_SIZE + i] = payload[i];
+
+  size = Packet_FrameSeal(buffer->bytes, command, length);
+  if (!UART_OutBuffer(buffer->bytes, size, &buffer->busy))
+  {
+    buffer->busy = false;
+    return false;
+  }
+
+  return true;
+}
+
+/*! @brief Feeds one received byte to the parser for the current session.
+ *
+ *  @param data The received byte.
+ *  @param packet A pointer to where a completed packet is written.
+ *  @return bool - TRUE if the byte completed a valid packet.
+ */
+static bool ParseByte(const uint8_t data, TPacket* const packet)
+{
+  uint8_t frameState = FrameParser.state;
+  bool frameDone;
+
+  if (Protocol == PACKET_PROTOCOL_LEGACY)
+    return Packet_ParserFeed(&Parser, data, packet);
+
+  frameDone = Packet_FrameParserFeed(&FrameParser, data, packet);
+
+  // A byte that starts, continues, finishes or rejects a frame is never part of a legacy packet
+  if ((frameState != FRAME_STATE_MARKER) || (FrameParser.state != FRAME_STATE_MARKER))
+  {
+    Packet_ParserInit(&Parser);
+    return frameDone;
+  }
+
+  // A legacy packet arriving wholly between frames means a legacy tool is now talking to us
+  if (Packet_ParserFeed(&Parser, data, packet))
+  {
+    Protocol = PACKET_PROTOCOL_LEGACY;
+    return true;
+  }
+
+  return false;
 }
 
-void Packet_Put(const uint8_t command, const uint8_t parameter1, const uint8_t parameter2, const uint8_t parameter3)
+bool Packet_Get(TPacket* const packet)
 {
-  OS_DisableInterrupts();
+  uint8_t data;
 
-  UART_OutChar(command);
-  UART_OutChar(parameter1);
-  UART_OutChar(parameter2);
-  UART_OutChar(parameter3);
-  UART_OutChar((command ^ parameter1 ^ parameter2 ^ parameter3));
+  // Parse everything received so far, leaving the rest in the UART if the queue fills up
+  while (((uint8_t)(QueueHead - QueueTail) < PACKET_QUEUE_SIZE) && UART_InChar(&data))
+  {
+    if (ParseByte(data, &PacketQueue[QueueHead & (PACKET_QUEUE_SIZE - 1)]))
+      QueueHead++;
+  }
+
+  if (QueueHead == QueueTail)
+    return false;
+
+  *packet = PacketQueue[QueueTail & (PACKET_QUEUE_SIZE - 1)];
+  QueueTail++;
+
+  return true;
+}
+
+bool Packet_Put(const uint8_t command, const uint8_t parameter1, const uint8_t parameter2, const uint8_t parameter3)
+{
+  if (Protocol == PACKET_PROTOCOL_EXTENDED)
+  {
+    uint8_t frame[PACKET_FRAME_HEADER_SIZE + PACKET_FRAME_COMMAND_PAYLOAD + PACKET_FRAME_TRAILER_SIZE];
+
+    frame[PACKET_FRAME_HEADER_SIZE]     = parameter1;
+    frame[PACKET_FRAME_HEADER_SIZE + 1] = parameter2;
+    frame[PACKET_FRAME_HEADER_SIZE + 2] = parameter3;
+
+    return UART_OutFrame(frame, Packet_FrameSeal(frame, command, PACKET_FRAME_COMMAND_PAYLOAD));
+  }
+
+  const uint8_t packet[PACKET_NB_BYTES] =
+  {
+    command,
+    parameter1,
+    parameter2,
+    parameter3,
+    (command ^ parameter1 ^ parameter2 ^ parameter3)
+  };
 
-  OS_EnableInterrupts();
+  // Queued as one frame, so packets from different threads can never interleave
+  return UART_OutFrame(packet, PACKET_NB_BYTES);
 }
 
 /*!
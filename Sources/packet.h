@@ -17,6 +17,19 @@
 // Packet structure
 #define PACKET_NB_BYTES 5
 
+// Number of validated packets that can wait to be handled - must be a power of 2
+#define PACKET_QUEUE_SIZE 16
+
+// Extended frame: marker, command, payload length (little endian), payload, CRC-16 (little endian)
+// The CRC covers the command, length and payload.
+#define PACKET_FRAME_MARKER       0x7E
+#define PACKET_FRAME_HEADER_SIZE  4
+#define PACKET_FRAME_TRAILER_SIZE 2
+#define PACKET_FRAME_MAX_PAYLOAD  256
+#define PACKET_FRAME_MAX_SIZE     (PACKET_FRAME_HEADER_SIZE + PACKET_FRAME_MAX_PAYLOAD + PACKET_FRAME_TRAILER_SIZE)
+// Payload size of an extended frame carrying a command with its three parameters
+#define PACKET_FRAME_COMMAND_PAYLOAD (PACKET_NB_BYTES - 2)
+
 #pragma pack(push)
 #pragma pack(1)
 
@@ -51,15 +64,48 @@ typedef union
 
 #pragma pack(pop)
 
-#define Packet_Command     Packet.packetStruct.command
-#define Packet_Parameter1  Packet.packetStruct.parameters.separate.parameter1
-#define Packet_Parameter2  Packet.packetStruct.parameters.separate.parameter2
-#define Packet_Parameter3  Packet.packetStruct.parameters.separate.parameter3
-#define Packet_Parameter12 Packet.packetStruct.parameters.combined12.parameter12
-#define Packet_Parameter23 Packet.packetStruct.parameters.combined23.parameter23
-#define Packet_Checksum    Packet.packetStruct.checksum
+/*!
+ * @struct TPacketParser
+ * @brief Incremental parser state for extracting packets from a byte stream.
+ */
+typedef struct
+{
+  uint8_t window[PACKET_NB_BYTES];    /*!< The most recent bytes, as a circular buffer. */
+  uint8_t oldest;                     /*!< Index of the oldest byte in the window. */
+  uint8_t count;                      /*!< Number of bytes in the window. */
+  uint8_t checksum;                   /*!< XOR of every byte in the window. */
+} TPacketParser;
+
+/*! @brief The framing used on the serial port in a session.
+ *
+ */
+typedef enum
+{
+  PACKET_PROTOCOL_LEGACY,             /*!< 5-byte packets with an XOR checksum. */
+  PACKET_PROTOCOL_EXTENDED            /*!< Variable length frames with a CRC-16. */
+} TPacketProtocol;
+
+/*!
+ * @struct TFrameParser
+ * @brief Incremental parser state for extracting extended frames from a byte stream.
+ */
+typedef struct
+{
+  uint8_t state;                      /*!< The field the next byte belongs to. */
+  uint8_t command;                    /*!< The frame's command. */
+  uint16_t length;                    /*!< The frame's payload length. */
+  uint16_t count;                     /*!< Number of payload bytes received. */
+  uint16_t crc;                       /*!< CRC-16 of the frame so far. */
+  uint8_t payload[PACKET_FRAME_COMMAND_PAYLOAD]; /*!< The start of the payload. */
+} TFrameParser;
 
-extern TPacket Packet;
+#define Packet_Command(packet)     ((packet)->packetStruct.command)
+#define Packet_Parameter1(packet)  ((packet)->packetStruct.parameters.separate.parameter1)
+#define Packet_Parameter2(packet)  ((packet)->packetStruct.parameters.separate.parameter2)
+#define Packet_Parameter3(packet)  ((packet)->packetStruct.parameters.separate.parameter3)
+#define Packet_Parameter12(packet) ((packet)->packetStruct.parameters.combined12.parameter12)
+#define Packet_Parameter23(packet) ((packet)->packetStruct.parameters.combined23.parameter23)
+#define Packet_Checksum(packet)    ((packet)->packetStruct.checksum)
 
 // Acknowledgment bit mask
 extern const uint8_t PACKET_ACK_MASK;
@@ -72,16 +118,85 @@ extern const uint8_t PACKET_ACK_MASK;
  */
 bool Packet_Init(const uint32_t baudRate, const uint32_t moduleClk);
 
+/*! @brief Resets a parser so the next byte fed is taken as the start of a packet.
+ *
+ *  @param parser A pointer to the parser to reset.
+ */
+void Packet_ParserInit(TPacketParser* const parser);
+
+/*! @brief Feeds one received byte to a parser.
+ *
+ *  On a checksum mismatch the oldest byte is dropped, so the parser resyncs in constant time per byte.
+ *  @param parser A pointer to a parser set up with Packet_ParserInit.
+ *  @param data The received byte.
+ *  @param packet A pointer to where a completed packet is written.
+ *  @return bool - TRUE if the byte completed a valid packet.
+ */
+bool Packet_ParserFeed(TPacketParser* const parser, const uint8_t data, TPacket* const packet);
+
+/*! @brief Resets an extended frame parser to wait for the next frame marker.
+ *
+ *  @param parser A pointer to the parser to reset.
+ */
+void Packet_FrameParserInit(TFrameParser* const parser);
+
+/*! @brief Feeds one received byte to an extended frame parser.
+ *
+ *  Frames with a bad CRC are dropped and the parser waits for the next marker.
+ *  @param parser A pointer to a parser set up with Packet_FrameParserInit.
+ *  @param data The received byte.
+ *  @param packet A pointer to where a completed command frame is written, as a packet.
+ *  @return bool - TRUE if the byte completed a valid frame carrying a command and its three parameters.
+ */
+bool Packet_FrameParserFeed(TFrameParser* const parser, const uint8_t data, TPacket* const packet);
+
+/*! @brief Selects the framing for the rest of the session.
+ *
+ *  @param protocol The framing to receive and send in.
+ *  @return bool - TRUE if the framing was selected.
+ *  @note A valid legacy packet received between extended frames drops the session back to legacy framing,
+ *        so tools that only know the 5-byte packets keep working. Only bytes the frame parser skipped
+ *        while waiting for a marker count, so the tail of a corrupt or bulk frame is never taken for one.
+ */
+bool Packet_SetProtocol(const TPacketProtocol protocol);
+
+/*! @brief Gets the framing used by the current session.
+ *
+ *  @return TPacketProtocol - The framing in use.
+ */
+TPacketProtocol Packet_GetProtocol(void);
+
+/*! @brief Fills in the header and CRC of an extended frame built in place.
+ *
+ *  @param frame A pointer to a buffer with the payload already at frame + PACKET_FRAME_HEADER_SIZE.
+ *  @param command The frame's command.
+ *  @param length The payload length, at most PACKET_FRAME_MAX_PAYLOAD.
+ *  @return uint16_t - The total number of bytes in the frame, or 0 if the length is invalid.
+ */
+uint16_t Packet_FrameSeal(uint8_t* const frame, const uint8_t command, const uint16_t length);
+
+/*! @brief Sends a bulk payload as one extended frame.
+ *
+ *  @param command The frame's command.
+ *  @param payload A pointer to the payload - copied, so it may be reused on return.
+ *  @param length The payload length, at most PACKET_FRAME_MAX_PAYLOAD.
+ *  @return bool - TRUE if the frame was queued, FALSE if the session is not extended or no frame buffer is free.
+ */
+bool Packet_PutFrame(const uint8_t command, const uint8_t* const payload, const uint16_t length);
+
 /*! @brief Attempts to get a packet from the received data.
  *
+ *  Parses all received data and queues every valid packet, then takes the oldest.
+ *  @param packet A pointer to where the packet is copied.
  *  @return bool - TRUE if a valid packet was received.
+ *  @note Never blocks - returns FALSE once the queued packets have been used up.
  */
-void Packet_Get(void);
+bool Packet_Get(TPacket* const packet);
 
 /*! @brief Builds a packet and places it in the transmit FIFO buffer.
  *
  *  @return bool - TRUE if a valid packet was sent.
  */
-void Packet_Put(const uint8_t command, const uint8_t parameter1, const uint8_t parameter2, const uint8_t parameter3);
+bool Packet_Put(const uint8_t command, const uint8_t parameter1, const uint8_t parameter2, const uint8_t parameter3);
 
 #endif